@@ -0,0 +1,40 @@
+//================================================================================
+// "MIT License"
+//================================================================================
+// Copyright 2023 Michael J. Mannon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//================================================================================
+
+//======================================================================
+// tbx.rand.cpp
+//======================================================================
+// Explicit instantiations of rand_replacement, rr(), and the rand()
+// family, for each of the fundamental types that rand() accepts.
+//
+// Link this file with programs that define TBX_RAND_EXTERN_TEMPLATES,
+// or that include only tbx.rand.fwd.h. Compile it with the same
+// feature macros as the rest of the program.
+//======================================================================
+
+#include "tbx.rand.h"
+
+TBX_RAND_INSTANTIATIONS_ALL()
+
+// end file: tbx.rand.cpp
@@ -0,0 +1,78 @@
+#ifndef TBX_RAND_FWD_H
+#define TBX_RAND_FWD_H
+//================================================================================
+// "MIT License"
+//================================================================================
+// Copyright 2023 Michael J. Mannon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//================================================================================
+
+//======================================================================
+// tbx.rand.fwd.h
+//======================================================================
+// Declarations of the rand() family, without the definitions, and
+// without <random>. A translation unit that only calls
+//
+//    tbx::rand<ResultType>()
+//    tbx::rand<ResultType>(a, b)
+//    tbx::rand_max<ResultType>()
+//    tbx::srand<ResultType>(), and srand<ResultType>(seed)
+//
+// can include this header instead of tbx.rand.h, provided that the
+// program is linked with tbx.rand.cpp, which explicitly instantiates
+// those functions for each of the fundamental types listed in the
+// README.
+//
+// tbx.rand.h includes this header, so the default template arguments
+// declared here apply everywhere.
+//======================================================================
+
+#include <cstdint>      // uint_fast32_t
+#include <type_traits>  // enable_if_t, is_arithmetic
+
+namespace tbx
+{
+    template <typename ResultType, typename = void>
+    class rand_replacement;
+
+    template <typename ResultType>
+    tbx::rand_replacement<ResultType>& rr();
+
+    template <typename ResultType = int>
+    ResultType rand();
+
+    template <typename ResultType = int>
+    ResultType rand(ResultType const a, ResultType const b);
+
+    template <typename ResultType = int>
+    ResultType rand_max();
+
+    template <typename ResultType = int>
+    void srand();
+
+    // std::uint_fast32_t is std::mt19937::result_type.
+    template <typename ResultType = int>
+    void srand(std::uint_fast32_t const seed);
+
+    template <typename ResultType = int, typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+    void srand(SeedSeq& sseq);
+}   // end namespace tbx
+#endif  // TBX_RAND_FWD_H
+// end file: tbx.rand.fwd.h
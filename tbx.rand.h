@@ -81,7 +81,9 @@
 // the four overloads described above, share a common random number 
 // engine and distribution. 
 // 
-// The engine is std::mt19937. 
+// The engine is std::mt19937. When TBX_RAND_COMPACT_MT19937 is 
+// defined, it is tbx::mt19937, which produces identical output, using 
+// half the storage. 
 // 
 // The distribution varies, depending on ResultType. For integral 
 // types, the distribution is std::uniform_int_distribution. For 
@@ -113,17 +115,44 @@
 // engine for type int.
 //======================================================================
 
+#include <algorithm>         // iter_swap, max, min
 #include <array>             // array
+#include <atomic>            // atomic
+#include <cmath>             // abs, cbrt, cos, exp, floor, ldexp, log, log1p, nextafter, pow, sin, sqrt
 #include <cstddef>           // size_t
 #include <cstdint>           // uint_fast16_t, uint_least32_t
+#include <cstdio>            // fprintf, snprintf
+#include <cstdlib>           // abort
+#include <cstring>           // memcmp, memcpy
+#include <exception>         // current_exception, exception_ptr, rethrow_exception
 #include <initializer_list>  // initializer_list
-#include <iterator>          // interator_traits
+#include <iterator>          // input_iterator_tag, interator_traits
 #include <limits>            // numeric_limits
+#include <mutex>             // lock_guard, mutex
 #include <random>            // mt19937, random_device, seed_seq, uniform_int_distribution, uniform_real_distribution
-#include <sstream>           // stringstream
 #include <stdexcept>         // invalid_argument
-#include <type_traits>       // enable_if_t, integral_constant, is_floating_point_v, is_integral_v, 
-                             // is_same_v, remove_cv_t, is_unsigned_v
+#include <string>            // string
+#include <string_view>       // string_view
+#include <thread>            // thread
+#include <type_traits>       // conditional_t, decay_t, enable_if_t, integral_constant, invoke_result_t, is_base_of, is_floating_point_v, 
+                             // is_integral_v, is_lvalue_reference, is_same_v, is_trivially_copyable, 
+                             // remove_cv_t, is_unsigned_v
+#include <utility>           // declval, move
+#include <vector>            // vector
+#include "tbx.rand.fwd.h"    // declarations, and default template arguments, of rand(), srand(), etc.
+#if defined(TBX_RAND_TAPE)
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>           // open
+#include <sys/mman.h>        // mmap, munmap
+#include <sys/stat.h>        // fstat
+#include <unistd.h>          // close, ftruncate
+#else
+#error "TBX_RAND_TAPE requires POSIX mmap"
+#endif
+#endif
+#if defined(__SSSE3__)
+#include <immintrin.h>       // _mm_shuffle_epi8
+#endif
 
 namespace tbx
 {
@@ -290,38 +319,1116 @@ namespace tbx
         }
     };
 
+    //==================================================================
+    // fixed_seed_seq
+    //==================================================================
+    // tbx::fixed_seed_seq<N> is a seed sequence, for use wherever a
+    // std::seed_seq can be used, but it does not allocate. Its entropy
+    // is mixed into a std::array of N 32-bit words, when it is built,
+    // and generate() hashes those words into as many seeds as are
+    // requested, in a single pass. std::seed_seq, by contrast, stores
+    // its input in a std::vector, and makes several passes over the
+    // output of generate().
+    //
+    // The mixing functions are from Melissa O'Neill's seed_seq_fe, in
+    // "randutils." Every step is invertible, so param() can recover N
+    // words that, passed to the constructor, rebuild the same state. If
+    // more than N words are passed to the constructor, the extra words
+    // are folded into the state, and are not recoverable as such.
+    //
+    //   tbx::fixed_seed_seq<4> sseq{ key_lo, key_hi, task_id };
+    //   tbx::srand<double>(sseq);
+    template <std::size_t N = 8u>
+    class fixed_seed_seq
+    {
+        static_assert(N > 0u, "");
+    public:
+        using result_type = std::uint32_t;
+    private:
+        enum : result_type
+        {
+            init_a = 0x43b0'd7e5u, mult_a = 0x931e'8875u,
+            init_b = 0x8b51'f9ddu, mult_b = 0x58f3'8dedu,
+            mix_mult_l = 0xca01'f9ddu, mix_mult_r = 0x4973'f715u
+        };
+        enum : unsigned { xshift = 16u };
+        std::array<result_type, N> mixer_{};
+
+        // The multiplicative inverse of an odd number, modulo 2^32, by
+        // Newton's method. Each iteration doubles the number of correct
+        // bits; the first approximation, x = a, has three.
+        static constexpr result_type inverse(result_type const a) noexcept
+        {
+            auto x{ a };
+            for (int i{ 4 }; i--;)
+                x *= 2u - a * x;
+            return x;
+        }
+        static constexpr result_type power(result_type x, std::size_t n) noexcept
+        {
+            result_type p{ 1u };
+            for (; n; n >>= 1, x *= x)
+                if (n & 1u)
+                    p *= x;
+            return p;
+        }
+        static constexpr result_type mix(result_type const x, result_type const y) noexcept
+        {
+            auto const r{ static_cast<result_type>(mix_mult_l * x - mix_mult_r * y) };
+            return r ^ (r >> xshift);
+        }
+        template <typename InputIt>
+        void mix_entropy(InputIt first, InputIt const last)
+        {
+            result_type hash_const{ init_a };
+            auto hash = [&hash_const](result_type value) {
+                value ^= hash_const;
+                hash_const *= mult_a;
+                value *= hash_const;
+                return static_cast<result_type>(value ^ (value >> xshift));
+            };
+            for (auto& m : mixer_)
+                m = hash(first != last ? static_cast<result_type>(*first++) : 0u);
+            for (std::size_t src{}; src < N; ++src)
+                for (std::size_t dest{}; dest < N; ++dest)
+                    if (src != dest)
+                        mixer_[dest] = mix(mixer_[dest], hash(mixer_[src]));
+            for (; first != last; ++first)
+                for (auto& m : mixer_)
+                    m = mix(m, hash(static_cast<result_type>(*first)));
+        }
+    public:
+        fixed_seed_seq() noexcept
+        {
+            result_type const* const none{};
+            mix_entropy(none, none);
+        }
+        template <typename InputIt>
+        fixed_seed_seq(InputIt const first, InputIt const last)
+        {
+            using value_type = typename std::iterator_traits<InputIt>::value_type;
+            static_assert(std::is_integral_v<value_type>, "");
+            mix_entropy(first, last);
+        }
+        template <typename T>
+        fixed_seed_seq(std::initializer_list<T> const li)
+        {
+            static_assert(std::is_integral_v<T>, "");
+            mix_entropy(li.begin(), li.end());
+        }
+        template <typename RandomIt>
+        void generate(RandomIt first, RandomIt const last) const
+        {
+            using value_type = typename std::iterator_traits<RandomIt>::value_type;
+            static_assert(std::is_unsigned_v<value_type>, "");
+            static_assert(sizeof(value_type) >= sizeof(std::uint_least32_t), "");
+            result_type hash_const{ init_b };
+            for (std::size_t i{}; first != last; ++first)
+            {
+                auto value{ static_cast<result_type>(mixer_[i] ^ hash_const) };
+                hash_const *= mult_b;
+                value *= hash_const;
+                *first = static_cast<value_type>(value ^ (value >> xshift));
+                i = i + 1u < N ? i + 1u : 0u;
+            }
+        }
+        template <typename OutputIt>
+        void param(OutputIt dest) const
+        {
+            // Run mix_entropy backwards, as if it had been given N words.
+            auto m{ mixer_ };
+            auto const inv_a{ inverse(mult_a) };
+            auto const inv_mix_l{ inverse(mix_mult_l) };
+            auto hash_const{ static_cast<result_type>(init_a * power(mult_a, N * N)) };
+            for (auto src{ N }; src--;)
+            {
+                for (auto dest{ N }; dest--;)
+                {
+                    if (src == dest)
+                        continue;
+                    auto const post{ hash_const };
+                    hash_const *= inv_a;
+                    auto hashed{ static_cast<result_type>((m[src] ^ hash_const) * post) };
+                    hashed ^= hashed >> xshift;
+                    auto unmixed{ static_cast<result_type>(m[dest] ^ (m[dest] >> xshift)) };
+                    unmixed = static_cast<result_type>((unmixed + mix_mult_r * hashed) * inv_mix_l);
+                    m[dest] = unmixed;
+                }
+            }
+            for (auto i{ N }; i--;)
+            {
+                auto const post{ hash_const };
+                hash_const *= inv_a;
+                auto value{ static_cast<result_type>(m[i] ^ (m[i] >> xshift)) };
+                value *= inverse(post);
+                m[i] = value ^ hash_const;
+            }
+            for (auto const word : m)
+                *dest++ = word;
+        }
+        static constexpr std::size_t size() noexcept { return N; }
+    };
+    //------------------------------------------------------------------
+    namespace detail
+    {
+        // std::seed_seq::generate() is not const, so a const std::seed_seq
+        // cannot seed an engine directly. A copy, rebuilt from its
+        // parameters, generates the same seeds.
+        template <typename URBG>
+        inline void seed_from_const(URBG& eng, std::seed_seq const& sseq)
+        {
+            std::vector<std::seed_seq::result_type> v(sseq.size());
+            sseq.param(v.begin());
+            std::seed_seq copy(v.begin(), v.end());
+            eng.seed(copy);
+        }
+    }
+
+    //==================================================================
+    // bulk_isa - runtime dispatch of bulk kernels
+    //==================================================================
+    // The bulk kernels of the library are plain loops: the twist that
+    // refills the state of tbx::mt19937, and the passes of bulk
+    // generation (see generate_block and rand_bounded_batch) that
+    // reduce raw engine words to bounded integers, or convert them to
+    // floating point. A compiler
+    // vectorizes such loops for the instruction set it targets, which,
+    // without -march, is the least common denominator.
+    //
+    // With GCC or Clang on x86-64, each kernel is also compiled for SSE4.2,
+    // AVX2 and AVX-512, by way of target attributes, and the best
+    // variant that the CPU supports is selected on first use, with
+    // cpuid. One binary runs the fastest kernels on every host.
+    // Elsewhere, or when TBX_RAND_NO_CPU_DISPATCH is defined, there is
+    // only the baseline variant, compiled for the target of the build.
+    //
+    //    tbx::bulk_isa_selected()     the variant in use
+    //    tbx::bulk_isa_supported()    the best variant the CPU supports
+    //    tbx::bulk_isa_select(isa)    select another variant
+    //    tbx::bulk_isa_name(isa)      "baseline", "sse4.2", "avx2" or "avx512"
+    //
+    // All variants compute the same values, bit for bit, so selection
+    // affects speed, never output. Kernels that do floating-point
+    // arithmetic stop at AVX2: AVX-512 implies FMA, and a fused
+    // multiply-add rounds differently.
+    //
+    // The loops vectorize fully at -O3. (At -O2, GCC vectorizes only
+    // the simplest loops.)
+#if !defined(TBX_RAND_NO_CPU_DISPATCH) && defined(__GNUC__) && defined(__x86_64__)
+#define TBX_RAND_CPU_DISPATCH
+#define TBX_RAND_KERNEL_BODY __attribute__((always_inline)) inline
+#define TBX_RAND_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TBX_RAND_KERNEL_BODY inline
+#endif
+    enum class bulk_isa { baseline, sse4_2, avx2, avx512 };
+    namespace detail
+    {
+        inline tbx::bulk_isa detect_bulk_isa() noexcept
+        {
+#if defined(TBX_RAND_CPU_DISPATCH)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")
+                && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq"))
+                return tbx::bulk_isa::avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return tbx::bulk_isa::avx2;
+            if (__builtin_cpu_supports("sse4.2"))
+                return tbx::bulk_isa::sse4_2;
+#endif
+            return tbx::bulk_isa::baseline;
+        }
+        //--------------------------------------------------------------
+        inline std::atomic<tbx::bulk_isa>& selected_bulk_isa() noexcept
+        {
+            static std::atomic<tbx::bulk_isa> isa{ tbx::detail::detect_bulk_isa() };
+            return isa;
+        }
+        //--------------------------------------------------------------
+        // A kernel is a class with a static member function, body, and
+        // a constant, floating_point. dispatch<Kernel>(args...) calls
+        // the variant of body for the selected instruction set.
+        template <typename Kernel, typename... Args>
+        struct kernel_variants
+        {
+            using result_type = decltype(Kernel::body(std::declval<Args>()...));
+            using function_type = result_type (*)(Args...);
+#if defined(TBX_RAND_CPU_DISPATCH)
+            static result_type baseline(Args... args) { return Kernel::body(args...); }
+            TBX_RAND_TARGET("sse4.2")
+            static result_type sse4_2(Args... args) { return Kernel::body(args...); }
+            TBX_RAND_TARGET("avx2")
+            static result_type avx2(Args... args) { return Kernel::body(args...); }
+            TBX_RAND_TARGET("avx512f,avx512vl,avx512bw,avx512dq")
+            static result_type avx512(Args... args) { return Kernel::body(args...); }
+            static constexpr function_type table[]
+            {
+                &kernel_variants::baseline,
+                &kernel_variants::sse4_2,
+                &kernel_variants::avx2,
+                Kernel::floating_point ? &kernel_variants::avx2 : &kernel_variants::avx512
+            };
+#endif
+        };
+        template <typename Kernel, typename... Args>
+        inline decltype(auto) dispatch(Args... args)
+        {
+#if defined(TBX_RAND_CPU_DISPATCH)
+            auto const isa{ tbx::detail::selected_bulk_isa().load(std::memory_order_relaxed) };
+            return tbx::detail::kernel_variants<Kernel, Args...>::table[static_cast<std::size_t>(isa)](args...);
+#else
+            return Kernel::body(args...);
+#endif
+        }
+    }
+    //------------------------------------------------------------------
+    inline tbx::bulk_isa bulk_isa_supported() noexcept
+    {
+        static auto const isa{ tbx::detail::detect_bulk_isa() };
+        return isa;
+    }
+    inline tbx::bulk_isa bulk_isa_selected() noexcept
+    {
+        return tbx::detail::selected_bulk_isa().load(std::memory_order_relaxed);
+    }
+    inline void bulk_isa_select(tbx::bulk_isa const isa)
+    {
+        if (tbx::bulk_isa_supported() < isa)
+            throw std::invalid_argument(
+                "tbx::bulk_isa_select(isa): "
+                "isa is not supported by this CPU");
+        tbx::detail::selected_bulk_isa().store(isa, std::memory_order_relaxed);
+    }
+    inline char const* bulk_isa_name(tbx::bulk_isa const isa) noexcept
+    {
+        switch (isa)
+        {
+        case tbx::bulk_isa::sse4_2:  return "sse4.2";
+        case tbx::bulk_isa::avx2:    return "avx2";
+        case tbx::bulk_isa::avx512:  return "avx512";
+        default:                     return "baseline";
+        }
+    }
+
+    //==================================================================
+    // mt19937
+    //==================================================================
+    // tbx::mt19937 produces the same output as std::mt19937, value for
+    // value, but it stores its 624 state words as std::uint32_t. Where
+    // std::uint_fast32_t is 64 bits wide, as it is with glibc on x86-64,
+    // the state of std::mt19937 takes 5 KB, half of which is padding,
+    // and every twist touches twice as many cache lines as necessary.
+    // tbx::mt19937 takes 2.5 KB.
+    //
+    // When TBX_RAND_COMPACT_MT19937 is defined (identically, in every
+    // translation unit), tbx::mt19937 is the engine of rand_replacement,
+    // and so of tbx::rand() and its relatives. Seeding by value, by
+    // std::seed_seq, or by any other seed sequence gives the same
+    // streams as before.
+    //
+    // Seeding by value is constexpr. The state for seed 1u, which is
+    // the implicit seed of rand_replacement, is computed once, at
+    // compile time, and seeding with 1u merely copies it. With no
+    // distribution to construct (see rand_replacement), the
+    // thread_local engines of rr() are then constant-initialized: the
+    // state is part of the initial image of thread-local storage, which
+    // is copied when a thread starts. No guard is checked on each call,
+    // and no seeding is done on a thread's first call.
+    namespace detail
+    {
+        constexpr std::array<std::uint32_t, 624u> mt19937_seeded_state(std::uint32_t const value) noexcept
+        {
+            std::array<std::uint32_t, 624u> x{};
+            x[0] = value;
+            for (std::size_t k{ 1u }; k < x.size(); ++k)
+                x[k] = 1'812'433'253u * (x[k - 1u] ^ (x[k - 1u] >> 30)) + static_cast<std::uint32_t>(k);
+            return x;
+        }
+        inline constexpr auto mt19937_seed_1_state{ tbx::detail::mt19937_seeded_state(1u) };
+        //--------------------------------------------------------------
+        // The twist, which refills all 624 state words at once, is a
+        // bulk kernel. See bulk_isa.
+        struct mt19937_twist_kernel
+        {
+            enum : std::size_t { state_size = 624u, shift_size = 397u };
+            enum : std::uint32_t
+            {
+                matrix_a = 0x9908'b0dfu,
+                upper_mask = 0x8000'0000u,
+                lower_mask = 0x7fff'ffffu
+            };
+            bool static constexpr const floating_point{ false };
+            static constexpr std::uint32_t twist(std::uint32_t const u, std::uint32_t const v, std::uint32_t const m) noexcept
+            {
+                auto const y{ (u & upper_mask) | (v & lower_mask) };
+                return m ^ (y >> 1) ^ ((std::uint32_t{ 0u } - (y & 1u)) & matrix_a);
+            }
+            TBX_RAND_KERNEL_BODY
+            static void body(std::uint32_t* const x) noexcept
+            {
+                std::size_t k{};
+                for (; k < state_size - shift_size; ++k)
+                    x[k] = twist(x[k], x[k + 1u], x[k + shift_size]);
+                for (; k < state_size - 1u; ++k)
+                    x[k] = twist(x[k], x[k + 1u], x[k + shift_size - state_size]);
+                x[k] = twist(x[k], x[0], x[shift_size - 1u]);
+            }
+        };
+    }
+    class mt19937
+    {
+    public:
+        using result_type = std::uint32_t;
+        enum : std::size_t { state_size = 624u, shift_size = 397u };
+        auto static constexpr const default_seed{ result_type{ 5489u } };
+    private:
+        enum : result_type { upper_mask = 0x8000'0000u };
+        std::array<result_type, state_size> x_{};
+        std::size_t i_{ state_size };
+        void generate() noexcept
+        {
+            tbx::detail::dispatch<tbx::detail::mt19937_twist_kernel>(x_.data());
+            i_ = 0u;
+        }
+        static constexpr std::array<result_type, state_size> seeded_state(result_type const value) noexcept
+        {
+            return value == 1u
+                ? tbx::detail::mt19937_seed_1_state
+                : tbx::detail::mt19937_seeded_state(value);
+        }
+    public:
+        constexpr mt19937() noexcept
+            : mt19937(default_seed)
+        {}
+        constexpr explicit mt19937(result_type const value) noexcept
+            : x_{ seeded_state(value) }
+        {}
+        // Not for copies: a non-const mt19937 is not a seed sequence.
+        template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value
+            && !std::is_same_v<SeedSeq, mt19937>>>
+        explicit mt19937(SeedSeq& sseq)
+        {
+            seed(sseq);
+        }
+        constexpr void seed(result_type const value = default_seed) noexcept
+        {
+            x_ = seeded_state(value);
+            i_ = state_size;
+        }
+        template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+        void seed(SeedSeq& sseq)
+        {
+            sseq.generate(x_.begin(), x_.end());
+            // The state must not be all zeros (apart from the bits of
+            // x_[0] that the twist ignores).
+            auto zero{ (x_[0] & upper_mask) == 0u };
+            for (std::size_t k{ 1u }; zero && k < state_size; ++k)
+                zero = x_[k] == 0u;
+            if (zero)
+                x_[0] = upper_mask;
+            i_ = state_size;
+        }
+        static constexpr result_type min() noexcept { return 0u; }
+        static constexpr result_type max() noexcept { return 0xffff'ffffu; }
+        result_type operator()() noexcept
+        {
+            if (i_ == state_size)
+                generate();
+            auto y{ x_[i_++] };
+            y ^= y >> 11;
+            y ^= (y << 7) & 0x9d2c'5680u;
+            y ^= (y << 15) & 0xefc6'0000u;
+            return y ^ (y >> 18);
+        }
+        void discard(unsigned long long z) noexcept
+        {
+            for (; z; --z)
+                (*this)();
+        }
+        friend bool operator==(mt19937 const& a, mt19937 const& b) noexcept
+        {
+            // Equal engines produce equal output, from here on. Compare
+            // the words that have yet to be tempered, and the words that
+            // will feed the next twist.
+            return a.i_ == b.i_ && a.x_ == b.x_;
+        }
+        friend bool operator!=(mt19937 const& a, mt19937 const& b) noexcept { return !(a == b); }
+    };
+
+    //==================================================================
+    // default_urbg_type
+    //==================================================================
+    // The engine of rand_replacement
+#if defined(TBX_RAND_COMPACT_MT19937)
+    using default_urbg_type = tbx::mt19937;
+#else
+    using default_urbg_type = std::mt19937;
+#endif
+
+    //==================================================================
+    // variate tape (opt-in: #define TBX_RAND_TAPE)
+    //==================================================================
+    // When TBX_RAND_TAPE is defined (identically, in every translation
+    // unit), each rand_replacement carries a tape. A tape can record
+    // the values that rand(), rand(a, b) and rand(param) return in the
+    // calling thread, and it can replay them later:
+    //
+    //    tbx::tape_record<ResultType>(path)   record to a file
+    //    tbx::tape_replay<ResultType>(path)   replay from a file
+    //    tbx::tape_stop<ResultType>()         stop, and close the file
+    //
+    // Each thread, and each ResultType, needs a tape file of its own.
+    // The file is memory-mapped. A recording appends to it, and a
+    // replay reads its values in place, without consulting the engine
+    // at all. That makes replay cheaper than regeneration. It also
+    // means the engine is not advanced during a replay.
+    //
+    // Along with each value, a tape stores a hash of the call: which
+    // overload was called, and with what arguments. If a replay makes
+    // a different call, or runs past the end of the tape, a
+    // tbx::tape_divergence exception is thrown. Failure to open, map,
+    // or grow a file throws std::runtime_error.
+    //
+    // Only values returned by rand_replacement are recorded. Functions
+    // such as tbx::shuffle, which draw from urbg() directly, are not.
+    //
+    // A tape is stopped automatically when its thread exits. This
+    // feature requires POSIX mmap.
+    namespace detail
+    {
+        // The overload of rand_replacement::rand that made a call
+        enum class tape_call : std::uint64_t { rand = 1u, rand_a_b = 2u, rand_param = 3u, bernoulli = 4u };
+    }
+#if defined(TBX_RAND_TAPE)
+    class tape_divergence : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+    enum class tape_mode { off, record, replay };
+    namespace detail
+    {
+        inline std::uint64_t tape_mix(std::uint64_t z) noexcept
+        {
+            // The finalizer of splitmix64
+            z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9u;
+            z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11ebu;
+            return z ^ (z >> 31);
+        }
+        //--------------------------------------------------------------
+        template <typename T>
+        inline std::uint64_t tape_bits(T const x) noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                auto const d{ static_cast<double>(x) };
+                std::uint64_t bits;
+                std::memcpy(&bits, &d, sizeof bits);
+                return bits;
+            }
+            else
+            {
+                return static_cast<std::uint64_t>(x);
+            }
+        }
+        //--------------------------------------------------------------
+        template <typename ResultType>
+        class variate_tape
+        {
+            struct header
+            {
+                char magic[8];
+                std::uint64_t record_size;
+                std::uint64_t value_type;
+                std::uint64_t count;
+                std::uint64_t reserved[4];  // 64 bytes, to align the records
+            };
+            struct entry
+            {
+                std::uint64_t check;
+                ResultType value;
+            };
+            auto static constexpr const magic{ "tbxtape" };
+            // A tape records the size, signedness, and kind of ResultType.
+            auto static constexpr const value_type{ std::uint64_t{ sizeof(ResultType) }
+                | std::uint64_t{ std::is_signed_v<ResultType> } << 8
+                | std::uint64_t{ std::is_floating_point_v<ResultType> } << 9
+                | std::uint64_t{ std::is_same_v<ResultType, bool> } << 10 };
+            enum : std::size_t { initial_capacity = 4'096u };
+            tbx::tape_mode mode_{ tbx::tape_mode::off };
+            int fd_{ -1 };
+            void* map_{ nullptr };
+            std::size_t map_size_{};
+            std::size_t capacity_{};  // records
+            std::size_t next_{};      // records
+            std::size_t count_{};     // records
+            std::string path_;
+        public:
+            variate_tape() noexcept
+                = default;
+            // A copy (for instance, of a pooled engine) starts out with
+            // no tape.
+            variate_tape(variate_tape const&) noexcept
+            {}
+            variate_tape& operator=(variate_tape const&)
+            {
+                stop();
+                return *this;
+            }
+            ~variate_tape() { stop(); }
+            //----------------------------------------------------------
+            tbx::tape_mode mode() const noexcept   { return mode_; }
+            std::size_t position() const noexcept  { return next_; }
+            std::size_t size() const noexcept      { return count_; }
+            //----------------------------------------------------------
+            void record(std::string const& path)
+            {
+                stop();
+                path_ = path;
+                fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+                if (fd_ < 0)
+                    fail("tbx::tape_record(path): cannot open ");
+                map(initial_capacity, PROT_READ | PROT_WRITE);
+                auto* const h{ static_cast<header*>(map_) };
+                std::memcpy(h->magic, magic, sizeof h->magic);
+                h->record_size = sizeof(entry);
+                h->value_type = value_type;
+                h->count = 0u;
+                mode_ = tbx::tape_mode::record;
+            }
+            void replay(std::string const& path)
+            {
+                stop();
+                path_ = path;
+                fd_ = ::open(path.c_str(), O_RDONLY);
+                if (fd_ < 0)
+                    fail("tbx::tape_replay(path): cannot open ");
+                struct stat st;
+                if (::fstat(fd_, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(header))
+                    fail("tbx::tape_replay(path): not a tape: ");
+                map((static_cast<std::size_t>(st.st_size) - sizeof(header)) / sizeof(entry), PROT_READ);
+                auto const* const h{ static_cast<header const*>(map_) };
+                if (std::memcmp(h->magic, magic, sizeof h->magic) != 0 || h->record_size != sizeof(entry)
+                    || h->value_type != value_type)
+                    fail("tbx::tape_replay(path): not a tape for this ResultType: ");
+                count_ = static_cast<std::size_t>(h->count);
+                if (capacity_ < count_)
+                    fail("tbx::tape_replay(path): truncated tape: ");
+                mode_ = tbx::tape_mode::replay;
+            }
+            void stop() noexcept
+            {
+                if (map_)
+                    ::munmap(map_, map_size_);
+                if (fd_ >= 0)
+                {
+                    if (mode_ == tbx::tape_mode::record)
+                        static_cast<void>(::ftruncate(fd_, static_cast<off_t>(sizeof(header) + count_ * sizeof(entry))));
+                    ::close(fd_);
+                }
+                mode_ = tbx::tape_mode::off;
+                fd_ = -1;
+                map_ = nullptr;
+                map_size_ = capacity_ = next_ = count_ = 0u;
+            }
+            //----------------------------------------------------------
+            // Return the value of generate(), recording it if a recording
+            // is in progress. During a replay, return the value from the
+            // tape instead, and do not call generate().
+            template <typename T, typename Generate>
+            ResultType filter(tbx::detail::tape_call const call, T const a, T const b, Generate&& generate)
+            {
+                if (mode_ == tbx::tape_mode::off)
+                    return generate();
+                auto const check{ tbx::detail::tape_mix(
+                    static_cast<std::uint64_t>(call)
+                    ^ tbx::detail::tape_mix(tbx::detail::tape_bits(a))
+                    ^ tbx::detail::tape_mix(tbx::detail::tape_bits(b) + 1u)) };
+                if (mode_ == tbx::tape_mode::record)
+                {
+                    auto const value{ generate() };
+                    if (count_ == capacity_)
+                        grow();
+                    entries()[count_] = entry{ check, value };
+                    static_cast<header*>(map_)->count = ++count_;
+                    next_ = count_;
+                    return value;
+                }
+                if (next_ == count_)
+                    throw tbx::tape_divergence(
+                        "tbx::rand(): replay ran past the end of tape " + path_);
+                auto const& r{ entries()[next_] };
+                if (r.check != check)
+                    throw tbx::tape_divergence(
+                        "tbx::rand(): replay diverged from tape " + path_
+                        + " at call " + std::to_string(next_));
+                ++next_;
+                return r.value;
+            }
+        private:
+            entry* entries() const noexcept
+            {
+                return reinterpret_cast<entry*>(static_cast<char*>(map_) + sizeof(header));
+            }
+            void map(std::size_t const capacity, int const protection)
+            {
+                auto const size{ sizeof(header) + capacity * sizeof(entry) };
+                if (protection & PROT_WRITE)
+                    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+                        fail("tbx::tape_record(path): cannot grow ");
+                auto* const p{ ::mmap(nullptr, size, protection, MAP_SHARED, fd_, 0) };
+                if (p == MAP_FAILED)
+                    fail(protection & PROT_WRITE
+                        ? "tbx::tape_record(path): cannot map "
+                        : "tbx::tape_replay(path): cannot map ");
+                map_ = p;
+                map_size_ = size;
+                capacity_ = capacity;
+            }
+            void grow()
+            {
+                ::munmap(map_, map_size_);
+                map_ = nullptr;
+                map(capacity_ * 2u, PROT_READ | PROT_WRITE);
+            }
+            [[noreturn]] void fail(char const* const message)
+            {
+                auto const what{ message + path_ };
+                stop();
+                throw std::runtime_error(what);
+            }
+        };
+    }
+#endif
+
+#if defined(TBX_RAND_SHADOW)
+    //==================================================================
+    // shadow validation (opt-in: #define TBX_RAND_SHADOW)
+    //==================================================================
+    // When TBX_RAND_SHADOW is defined (identically, in every
+    // translation unit), each rand_replacement also keeps a reference
+    // engine and distribution: a std::mt19937, and a distribution of
+    // the same type as its own. The reference is seeded by every call
+    // to srand(), and stepped by every call to rand(), rand(a, b), and
+    // rand(param), right after the engine that produced the value.
+    //
+    // On the first call whose value differs from the reference value,
+    // the program prints the ResultType, the number of the call, both
+    // values, and the selected bulk_isa, to stderr, and calls
+    // std::abort. That proves, in a
+    // debug build, that an alternative engine (for instance, the one
+    // selected by TBX_RAND_COMPACT_MT19937) reproduces the stream that
+    // std::mt19937 produces, call for call.
+    //
+    // The engine itself is checked, too, word by word. The urbg_type of
+    // rand_replacement becomes a checked_engine, which steps another
+    // std::mt19937 along with the engine, and compares every word that
+    // it delivers, however it is drawn. That covers the bulk routines,
+    // such as tbx::shuffle, tbx::rand_range, and tbx::rand_mask, which
+    // draw from urbg() directly, as well as the dispatched twist of
+    // tbx::mt19937. On the first word that differs, the program prints
+    // the number of the word, both words, and the selected bulk_isa,
+    // and calls std::abort.
+    //
+    // Seed sequences are asked for their values once. The values are
+    // recorded, and replayed to the reference engines, so that even
+    // srand() with no arguments, which reads std::random_device, seeds
+    // all engines identically.
+    //
+    // The reference distribution cannot follow the bulk routines.
+    // After a call to urbg(), checking of values is suspended until the
+    // next call to srand(), but checking of words goes on.
+    //
+    // The checks cost two more engines, and triple the work of each
+    // call. They are meant for debug builds, not for production.
+    namespace detail
+    {
+        template <typename T>
+        char const* type_name() noexcept
+        {
+            using U = std::remove_cv_t<T>;
+            if constexpr (std::is_same_v<U, bool>) return "bool";
+            else if constexpr (std::is_same_v<U, char>) return "char";
+            else if constexpr (std::is_same_v<U, signed char>) return "signed char";
+            else if constexpr (std::is_same_v<U, unsigned char>) return "unsigned char";
+            else if constexpr (std::is_same_v<U, short>) return "short";
+            else if constexpr (std::is_same_v<U, unsigned short>) return "unsigned short";
+            else if constexpr (std::is_same_v<U, int>) return "int";
+            else if constexpr (std::is_same_v<U, unsigned int>) return "unsigned int";
+            else if constexpr (std::is_same_v<U, long>) return "long";
+            else if constexpr (std::is_same_v<U, unsigned long>) return "unsigned long";
+            else if constexpr (std::is_same_v<U, long long>) return "long long";
+            else if constexpr (std::is_same_v<U, unsigned long long>) return "unsigned long long";
+            else if constexpr (std::is_same_v<U, float>) return "float";
+            else if constexpr (std::is_same_v<U, double>) return "double";
+            else if constexpr (std::is_same_v<U, long double>) return "long double";
+            else return "ResultType";
+        }
+        //--------------------------------------------------------------
+        template <typename T>
+        void format_value(char* const buffer, std::size_t const size, T const x) noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                std::snprintf(buffer, size, "%.21Lg", static_cast<long double>(x));
+            else if constexpr (std::is_signed_v<T>)
+                std::snprintf(buffer, size, "%lld", static_cast<long long>(x));
+            else
+                std::snprintf(buffer, size, "%llu", static_cast<unsigned long long>(x));
+        }
+        //--------------------------------------------------------------
+        // A seed sequence that asks another for its values once, and
+        // returns the same values every time generate is called.
+        template <typename SeedSeq>
+        class replayed_seed_seq
+        {
+            SeedSeq& sseq_;
+            std::vector<std::uint_least32_t> v_;
+            bool recorded_{};
+        public:
+            using result_type = std::uint_least32_t;
+            explicit replayed_seed_seq(SeedSeq& sseq) noexcept
+                : sseq_{ sseq }
+            {}
+            template <typename RandomIt>
+            void generate(RandomIt const begin, RandomIt const end)
+            {
+                if (!recorded_)
+                {
+                    v_.resize(static_cast<std::size_t>(end - begin));
+                    sseq_.generate(v_.begin(), v_.end());
+                    recorded_ = true;
+                }
+                auto it{ v_.begin() };
+                for (auto i{ begin }; i != end && it != v_.end(); ++i, ++it)
+                    *i = *it;
+            }
+        };
+        //--------------------------------------------------------------
+        template <typename ResultType, typename Distribution>
+        class shadow_engine
+        {
+            std::mt19937 eng_{ 1u };
+            Distribution dist_;
+            std::uint64_t calls_{};
+            bool in_step_{ true };
+        public:
+            explicit shadow_engine(Distribution const& dist)
+                : dist_{ dist }
+            {}
+            std::uint64_t calls() const noexcept  { return calls_; }
+            bool in_step() const noexcept         { return in_step_; }
+            void lose_step() noexcept             { in_step_ = false; }
+            template <typename Seed>
+            void seed(Seed&& seed)
+            {
+                dist_.reset();
+                seed(eng_);
+                in_step_ = true;
+            }
+            template <typename Draw>
+            void check(ResultType const value, Draw&& draw)
+            {
+                ++calls_;
+                if (!in_step_)
+                    return;
+                auto const expected{ draw(eng_, dist_) };
+                if (value != expected)
+                {
+                    char fast[64], reference[64];
+                    tbx::detail::format_value(fast, sizeof fast, value);
+                    tbx::detail::format_value(reference, sizeof reference, expected);
+                    std::fprintf(stderr,
+                        "tbx::rand<%s>(): TBX_RAND_SHADOW divergence at call %llu: "
+                        "the engine returned %s, and the reference returned %s "
+                        "(bulk kernels: %s)\n",
+                        tbx::detail::type_name<ResultType>(),
+                        static_cast<unsigned long long>(calls_), fast, reference,
+                        tbx::bulk_isa_name(tbx::bulk_isa_selected()));
+                    std::abort();
+                }
+            }
+        };
+        //--------------------------------------------------------------
+        // The engine of rand_replacement, under TBX_RAND_SHADOW
+        template <typename Engine>
+        class checked_engine
+        {
+            Engine eng_;
+            std::mt19937 ref_;
+            std::uint64_t words_{};    // since the last seed
+        public:
+            using result_type = typename Engine::result_type;
+            auto static constexpr const default_seed{ Engine::default_seed };
+            explicit checked_engine(result_type const value = default_seed)
+                : eng_{ value }
+                , ref_{ static_cast<std::mt19937::result_type>(value) }
+            {}
+            void seed(result_type const value = default_seed)
+            {
+                eng_.seed(value);
+                ref_.seed(static_cast<std::mt19937::result_type>(value));
+                words_ = 0u;
+            }
+            template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+            void seed(SeedSeq& sseq)
+            {
+                tbx::detail::replayed_seed_seq<SeedSeq> replay{ sseq };
+                eng_.seed(replay);
+                ref_.seed(replay);
+                words_ = 0u;
+            }
+            static constexpr result_type min() noexcept { return Engine::min(); }
+            static constexpr result_type max() noexcept { return Engine::max(); }
+            result_type operator()()
+            {
+                auto const word{ eng_() };
+                auto const expected{ ref_() };
+                ++words_;
+                if (word != expected)
+                {
+                    std::fprintf(stderr,
+                        "tbx::rand_replacement<ResultType>::urbg(): TBX_RAND_SHADOW divergence at word %llu: "
+                        "the engine returned %llu, and std::mt19937 returned %llu "
+                        "(bulk kernels: %s)\n",
+                        static_cast<unsigned long long>(words_),
+                        static_cast<unsigned long long>(word),
+                        static_cast<unsigned long long>(expected),
+                        tbx::bulk_isa_name(tbx::bulk_isa_selected()));
+                    std::abort();
+                }
+                return word;
+            }
+            void discard(unsigned long long z)
+            {
+                for (; z; --z)
+                    (*this)();
+            }
+            std::uint64_t words() const noexcept  { return words_; }
+            friend bool operator==(checked_engine const& a, checked_engine const& b) noexcept { return a.eng_ == b.eng_; }
+            friend bool operator!=(checked_engine const& a, checked_engine const& b) noexcept { return !(a == b); }
+        };
+    }
+#endif
+
+    //==================================================================
+    // bernoulli_param
+    //==================================================================
+    // tbx::rand<bool>(p) returns true with probability p, for
+    // 0 <= p <= 1. That replaces tests such as tbx::rand<double>() < p,
+    // which convert a random word to floating point on every call.
+    //
+    // A bernoulli_param converts p, once, to a 64-bit threshold, t, the
+    // nearest multiple of 2^-64 at or below p. A decision compares a
+    // random word with the high half of t. Only when they are equal
+    // (once in 2^32 decisions, on average) is a second word drawn, and
+    // compared with the low half. So a decision costs one 32-bit word
+    // and one integer compare, and it is as exact as a comparison with
+    // a 64-bit word.
+    //
+    // When p is dyadic, p = k / 2^m, with m <= 32, a decision needs only
+    // m random bits. rand<bool>(p) takes them from a word that it holds
+    // back, so that one word serves 32 / m decisions: 32 when p is 1/2,
+    // 8 when p is 3/16. When p is 0 or 1, m is 0, and no bits are used.
+    //
+    // Precompute the param, and pass it to rand<bool>(param), when the
+    // same p is used repeatedly.
+    namespace detail
+    {
+        // Random bits held back by rand<bool>(bernoulli_param)
+        struct bit_pool
+        {
+            std::uint64_t bits{};
+            unsigned count{};
+        };
+    }
+    class bernoulli_param
+    {
+        double p_{ 0.5 };
+        std::uint64_t hi_{ 0x8000'0000u };  // high half of t; 2^32 when p == 1
+        std::uint32_t lo_{};                // low half of t
+        std::uint32_t k_{ 1u };             // p == k / 2^m_, when m_ <= 32
+        unsigned m_{ 1u };
+    public:
+        enum : unsigned { not_dyadic = 64u };
+        explicit bernoulli_param(double const p = 0.5)
+            : p_{ p }
+        {
+            if (!(0.0 <= p && p <= 1.0))
+                throw std::invalid_argument(
+                    "tbx::bernoulli_param::bernoulli_param(p): "
+                    "requires 0 <= p <= 1");
+            auto const t{ std::ldexp(p, 32) };  // exact
+            hi_ = static_cast<std::uint64_t>(t);
+            lo_ = static_cast<std::uint32_t>(std::ldexp(t - std::floor(t), 32));
+            if (t != std::floor(t))
+            {
+                m_ = not_dyadic;
+                k_ = 0u;
+                return;
+            }
+            m_ = 32u;
+            auto k{ hi_ };
+            while (m_ != 0u && k % 2u == 0u)
+            {
+                k /= 2u;
+                --m_;
+            }
+            k_ = static_cast<std::uint32_t>(k);
+        }
+        double p() const noexcept               { return p_; }
+
+        // m, when p = k / 2^m, with m <= 32; otherwise, not_dyadic
+        unsigned dyadic_bits() const noexcept   { return m_; }
+
+        // k, when p = k / 2^m, with m <= 32; otherwise, 0
+        std::uint32_t dyadic_numerator() const noexcept  { return k_; }
+
+        // The high and low halves of the threshold t
+        std::uint64_t threshold_high() const noexcept    { return hi_; }
+        std::uint32_t threshold_low() const noexcept     { return lo_; }
+
+        // One decision, using one word (rarely two) from g
+        template <typename URBG>
+        bool operator()(URBG& g) const
+        {
+            auto const w{ word(g) };
+            return w != hi_ ? w < hi_ : word(g) < lo_;
+        }
+
+        // One decision, using m bits from pool, when p is dyadic. The
+        // pool is refilled from g as needed.
+        template <typename URBG>
+        bool operator()(URBG& g, tbx::detail::bit_pool& pool) const
+        {
+            if (m_ == not_dyadic)
+                return (*this)(g);
+            if (pool.count < m_)
+            {
+                pool.bits = word(g);
+                pool.count = 32u;
+            }
+            auto const u{ pool.bits & ((std::uint64_t{ 1u } << m_) - 1u) };
+            pool.bits >>= m_;
+            pool.count -= m_;
+            return u < k_;
+        }
+        friend bool operator==(bernoulli_param const& a, bernoulli_param const& b) noexcept { return a.p_ == b.p_; }
+        friend bool operator!=(bernoulli_param const& a, bernoulli_param const& b) noexcept { return !(a == b); }
+    private:
+        template <typename URBG>
+        std::uint32_t static word(URBG& g)
+        {
+            using result_type = typename std::decay_t<URBG>::result_type;
+            static_assert(std::decay_t<URBG>::min() == result_type{ 0u }, "");
+            static_assert(std::decay_t<URBG>::max() >= result_type{ 0xffff'ffffu }, "");
+            return static_cast<std::uint32_t>(g());
+        }
+    };
+
     //==================================================================
     // rand_replacement
     //==================================================================
-    template <typename ResultType, typename = void>
+    template <typename ResultType, typename>
     class rand_replacement
     {
         static_assert(tbx::is_arithmetic_short_int_long_v<ResultType>, "");
     public:
-        using urbg_type = std::mt19937;
+#if defined(TBX_RAND_SHADOW)
+        using urbg_type = tbx::detail::checked_engine<tbx::default_urbg_type>;
+#else
+        using urbg_type = tbx::default_urbg_type;
+#endif
         using seed_type = typename std::mt19937::result_type;
         using distribution_type = tbx::uniform_distribution_t<ResultType>;
         using param_type = typename distribution_type::param_type;
         using result_type = ResultType;
     private:
         urbg_type eng_{ default_seed };
+#if defined(TBX_RAND_COMPACT_MT19937)
+        // The uniform distributions keep no state between calls, so a
+        // new one can serve each call. Without a distribution member,
+        // whose constructor is not constexpr, a rand_replacement can be
+        // constant-initialized. See mt19937.
+        static distribution_type dist()       { return distribution_type{}; }
+#else
         distribution_type dist_;
+        distribution_type& dist() noexcept    { return dist_; }
+#endif
+#if defined(TBX_RAND_TAPE)
+        tbx::detail::variate_tape<ResultType> tape_;
+#endif
+#if defined(TBX_RAND_SHADOW)
+        tbx::detail::shadow_engine<ResultType, distribution_type> shadow_{ dist() };
+#endif
     public:
         auto static constexpr const default_seed{ seed_type{1u} };
 
         // Drop-in replacements for rand(), RAND_MAX, and srand(seed)
-        auto rand()                           { return dist_(eng_); }
-        auto rand_max()                       { return dist_.max(); }
-        void srand(seed_type const seed)      { dist_.reset(); eng_.seed(seed); }
+        auto rand()                           { return draw(call::rand, 0, 0, [](auto& e, auto&& d) { return d(e); }); }
+        auto rand_max()                       { return dist().max(); }
+        void srand(seed_type const seed)      { reseed([seed](auto& e) { e.seed(seed); }); }
 
         // Non-standard overloads
-        void srand()                          { dist_.reset(); tbx::seed_seq_rd s; eng_.seed(s); }
-        void srand(std::seed_seq const& sseq) { dist_.reset(); eng_.seed(sseq); }
-        auto rand(param_type const& p)        { return dist_(eng_, p); }
+        void srand()                          { tbx::seed_seq_rd s; reseed_from(s); }
+        void srand(std::seed_seq const& sseq) { reseed([&sseq](auto& e) { tbx::detail::seed_from_const(e, sseq); }); }
+        template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+        void srand(SeedSeq& sseq)             { reseed_from(sseq); }
+        auto rand(param_type const& p)        { return draw(call::rand_param, p.a(), p.b(), [&p](auto& e, auto&& d) { return d(e, p); }); }
+#if defined(TBX_RAND_SHADOW)
+        auto& urbg() noexcept                 { shadow_.lose_step(); return eng_; }
+#else
+        auto& urbg() noexcept                 { return eng_; }
+#endif
         auto rand(result_type const a, result_type const b) {
-            return dist_(eng_, make_param(a, b));
+            auto const p{ make_param(a, b) };
+            return draw(call::rand_a_b, a, b, [&p](auto& e, auto&& d) { return d(e, p); });
         }
+#if defined(TBX_RAND_TAPE)
+        auto& tape() noexcept                 { return tape_; }
+#endif
+#if defined(TBX_RAND_SHADOW)
+        auto const& shadow() const noexcept   { return shadow_; }
+#endif
     private:
+        using call = tbx::detail::tape_call;
+
+        // Every value passes through draw, and every seed through
+        // reseed, so that a tape and a shadow engine can see them.
+        template <typename T, typename Draw>
+        result_type draw([[maybe_unused]] call const c, [[maybe_unused]] T const a, [[maybe_unused]] T const b, Draw&& d)
+        {
+            auto generate = [this, &d] {
+                auto const value{ d(eng_, dist()) };
+#if defined(TBX_RAND_SHADOW)
+                shadow_.check(value, d);
+#endif
+                return value;
+            };
+#if defined(TBX_RAND_TAPE)
+            return tape_.filter(c, a, b, generate);
+#else
+            return generate();
+#endif
+        }
+        template <typename Seed>
+        void reseed(Seed&& seed)
+        {
+            dist().reset();
+            seed(eng_);
+#if defined(TBX_RAND_SHADOW)
+            shadow_.seed(seed);
+#endif
+        }
+        template <typename SeedSeq>
+        void reseed_from(SeedSeq& sseq)
+        {
+#if defined(TBX_RAND_SHADOW)
+            tbx::detail::replayed_seed_seq<SeedSeq> replay{ sseq };
+            reseed([&replay](auto& e) { e.seed(replay); });
+#else
+            reseed([&sseq](auto& e) { e.seed(sseq); });
+#endif
+        }
         auto static constexpr make_param(result_type const a, result_type const b)
         {
             return param_type
@@ -343,7 +1450,11 @@ namespace tbx
     class rand_replacement<ResultType, std::enable_if_t<tbx::is_bool_or_char_v<ResultType>>>
     {
     public:
-        using urbg_type = std::mt19937;
+#if defined(TBX_RAND_SHADOW)
+        using urbg_type = tbx::detail::checked_engine<tbx::default_urbg_type>;
+#else
+        using urbg_type = tbx::default_urbg_type;
+#endif
         using seed_type = typename std::mt19937::result_type;
         using distribution_type = tbx::uniform_distribution_t<ResultType>;
         using param_type = typename distribution_type::param_type;
@@ -365,23 +1476,99 @@ namespace tbx
             return std::is_floating_point_v<result_type> ? result_type{ 1 } : rt_max();
         }
         urbg_type eng_{ default_seed };
+#if defined(TBX_RAND_COMPACT_MT19937)
+        // See the primary template.
+        static distribution_type dist()       { return distribution_type{ drt(result_type{}), drt(rt_default_b()) }; }
+#else
         distribution_type dist_{ drt(result_type{}), drt(rt_default_b()) };
+        distribution_type& dist() noexcept    { return dist_; }
+#endif
+        tbx::detail::bit_pool pool_;  // for rand(bernoulli_param), when ResultType is bool
+#if defined(TBX_RAND_TAPE)
+        tbx::detail::variate_tape<ResultType> tape_;
+#endif
+#if defined(TBX_RAND_SHADOW)
+        tbx::detail::shadow_engine<ResultType, distribution_type> shadow_{ dist() };
+#endif
     public:
         auto static constexpr const default_seed{ seed_type{1u} };
 
         // Drop-in replacements for rand(), RAND_MAX, and srand(seed)
-        auto rand()                           { return rt(dist_(eng_)); }
+        auto rand()                           { return draw(call::rand, 0, 0, [](auto& e, auto&& d) { return rt(d(e)); }); }
         auto rand_max()                       { return rt_max(); }
-        void srand(seed_type const seed)      { dist_.reset(); eng_.seed(seed); }
+        void srand(seed_type const seed)      { reseed([seed](auto& e) { e.seed(seed); }); }
 
         // Non-standard overloads
-        void srand()                          { dist_.reset(); tbx::seed_seq_rd s; eng_.seed(s); }
-        void srand(std::seed_seq const& sseq) { dist_.reset(); eng_.seed(sseq); }
-        auto rand(param_type const& p)        { check(p); return rt(dist_(eng_, p)); }
+        void srand()                          { tbx::seed_seq_rd s; reseed_from(s); }
+        void srand(std::seed_seq const& sseq) { reseed([&sseq](auto& e) { tbx::detail::seed_from_const(e, sseq); }); }
+        template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+        void srand(SeedSeq& sseq)             { reseed_from(sseq); }
+        auto rand(param_type const& p)        { check(p); return draw(call::rand_param, p.a(), p.b(), [&p](auto& e, auto&& d) { return rt(d(e, p)); }); }
+#if defined(TBX_RAND_SHADOW)
+        auto& urbg() noexcept                 { shadow_.lose_step(); return eng_; }
+#else
+        auto& urbg() noexcept                 { return eng_; }
+#endif
         auto rand(result_type const a, result_type const b) {
-            return rt(dist_(eng_, make_param(a, b)));
+            auto const p{ make_param(a, b) };
+            return draw(call::rand_a_b, a, b, [&p](auto& e, auto&& d) { return rt(d(e, p)); });
+        }
+        template <typename R = ResultType, typename = std::enable_if_t<std::is_same_v<R, bool>>>
+        bool rand(tbx::bernoulli_param const& p) {
+            if (p.dyadic_bits() == tbx::bernoulli_param::not_dyadic)
+                return draw(call::bernoulli, p.p(), 0.0, [&p](auto& e, auto&&) { return p(e); });
+#if defined(TBX_RAND_SHADOW)
+            shadow_.lose_step();  // The reference engine cannot follow the pool.
+#endif
+            return draw(call::bernoulli, p.p(), 0.0, [this, &p](auto& e, auto&&) { return p(e, pool_); });
         }
+#if defined(TBX_RAND_TAPE)
+        auto& tape() noexcept                 { return tape_; }
+#endif
+#if defined(TBX_RAND_SHADOW)
+        auto const& shadow() const noexcept   { return shadow_; }
+#endif
     private:
+        using call = tbx::detail::tape_call;
+
+        // Every value passes through draw, and every seed through
+        // reseed, so that a tape and a shadow engine can see them.
+        template <typename T, typename Draw>
+        result_type draw([[maybe_unused]] call const c, [[maybe_unused]] T const a, [[maybe_unused]] T const b, Draw&& d)
+        {
+            auto generate = [this, &d] {
+                auto const value{ d(eng_, dist()) };
+#if defined(TBX_RAND_SHADOW)
+                shadow_.check(value, d);
+#endif
+                return value;
+            };
+#if defined(TBX_RAND_TAPE)
+            return tape_.filter(c, a, b, generate);
+#else
+            return generate();
+#endif
+        }
+        template <typename Seed>
+        void reseed(Seed&& seed)
+        {
+            dist().reset();
+            pool_ = tbx::detail::bit_pool{};
+            seed(eng_);
+#if defined(TBX_RAND_SHADOW)
+            shadow_.seed(seed);
+#endif
+        }
+        template <typename SeedSeq>
+        void reseed_from(SeedSeq& sseq)
+        {
+#if defined(TBX_RAND_SHADOW)
+            tbx::detail::replayed_seed_seq<SeedSeq> replay{ sseq };
+            reseed([&replay](auto& e) { e.seed(replay); });
+#else
+            reseed([&sseq](auto& e) { e.seed(sseq); });
+#endif
+        }
         void static constexpr check(param_type const& params) {
             if (params.a() < drt(rt_min()) || drt(rt_max()) < params.b())
                 throw std::invalid_argument(
@@ -395,69 +1582,3684 @@ namespace tbx
         }
     };
 
+#if defined(TBX_RAND_ENGINE_POOL)
+    //==================================================================
+    // engine_pool (opt-in: #define TBX_RAND_ENGINE_POOL)
+    //==================================================================
+    // By default, the first call to rr<ResultType>() in a thread
+    // constructs a rand_replacement, which seeds all 624 state words
+    // of std::mt19937, and the rand_replacement is destroyed when the
+    // thread exits. Programs that create and destroy many short-lived
+    // threads pay for that initialization again and again.
+    //
+    // When TBX_RAND_ENGINE_POOL is defined (identically, in every
+    // translation unit), rr<ResultType>() instead adopts an engine
+    // from a process-wide pool, and parks it back in the pool when the
+    // thread exits. The pool is a fixed array of atomic pointers, so
+    // adopting and parking are lock-free. When the pool is empty, a
+    // new engine is copied from a pristine, default-seeded engine,
+    // which is cheaper than seeding one.
+    //
+    // With reseed_on_adopt(true), which is the default, an adopted
+    // engine is reset to the pristine state, so that every thread
+    // starts out as if srand(1u) had been called, just as it does
+    // without the pool. With reseed_on_adopt(false), the reset is
+    // skipped, and a thread continues the stream of the thread that
+    // parked the engine.
+    //
+    // prewarm(n) fills the pool at startup, so that no thread ever
+    // needs to create an engine.
+    template <typename ResultType>
+    class engine_pool
+    {
+    public:
+        using engine_type = tbx::rand_replacement<ResultType>;
+        enum : std::size_t { capacity = 64u };
+    private:
+        struct slots
+        {
+            std::array<std::atomic<engine_type*>, capacity> parked{};
+            ~slots()
+            {
+                for (auto& slot : parked)
+                    delete slot.exchange(nullptr);
+            }
+        };
+        inline static slots slots_{};
+        inline static std::atomic<bool> reseed_on_adopt_{ true };
+        static engine_type const& pristine()
+        {
+            static engine_type const e;
+            return e;
+        }
+        static bool try_park(engine_type* const e) noexcept
+        {
+            for (auto& slot : slots_.parked)
+            {
+                engine_type* expected{};
+                if (slot.load(std::memory_order_relaxed) == nullptr
+                    && slot.compare_exchange_strong(expected, e, std::memory_order_release, std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+    public:
+        static engine_type* adopt()
+        {
+            for (auto& slot : slots_.parked)
+            {
+                if (slot.load(std::memory_order_relaxed) != nullptr)
+                {
+                    if (auto* const e{ slot.exchange(nullptr, std::memory_order_acquire) })
+                    {
+                        if (reseed_on_adopt_.load(std::memory_order_relaxed))
+                            *e = pristine();
+                        return e;
+                    }
+                }
+            }
+            return new engine_type(pristine());
+        }
+        static void park(engine_type* const e) noexcept
+        {
+            if (!try_park(e))
+                delete e;
+        }
+        static std::size_t prewarm(std::size_t n)
+        {
+            std::size_t parked{};
+            for (; n && parked < capacity; --n, ++parked)
+            {
+                auto* const e{ new engine_type(pristine()) };
+                if (!try_park(e))
+                {
+                    delete e;
+                    break;
+                }
+            }
+            return parked;
+        }
+        static std::size_t size() noexcept
+        {
+            std::size_t n{};
+            for (auto const& slot : slots_.parked)
+                n += slot.load(std::memory_order_relaxed) != nullptr;
+            return n;
+        }
+        static bool reseed_on_adopt() noexcept                { return reseed_on_adopt_.load(); }
+        static void reseed_on_adopt(bool const reseed) noexcept { reseed_on_adopt_.store(reseed); }
+    };
+    //------------------------------------------------------------------
+    namespace detail
+    {
+        // The thread_local handle of an adopted engine
+        template <typename ResultType>
+        class pooled_engine
+        {
+            tbx::rand_replacement<ResultType>* e_{ tbx::engine_pool<ResultType>::adopt() };
+        public:
+            pooled_engine()
+                = default;
+            pooled_engine(pooled_engine const&)
+                = delete;
+            pooled_engine& operator=(pooled_engine const&)
+                = delete;
+            ~pooled_engine()
+            {
+#if defined(TBX_RAND_TAPE)
+                e_->tape().stop();
+#endif
+                tbx::engine_pool<ResultType>::park(e_);
+            }
+            auto& get() noexcept { return *e_; }
+        };
+    }
+#endif
+
     //==================================================================
     // rr - "rand replacement"
     //==================================================================
     template <typename ResultType>
-    inline auto& rr()
+    tbx::rand_replacement<ResultType>& rr()
     {
         static_assert(tbx::is_arithmetic_v<ResultType>, "");
+#if defined(TBX_RAND_ENGINE_POOL)
+        static thread_local tbx::detail::pooled_engine<ResultType> r;
+        return r.get();
+#else
         static thread_local tbx::rand_replacement<ResultType> r;
         return r;
+#endif
     }
 
+#if defined(TBX_RAND_TAPE)
     //==================================================================
-    // rand(), srand(), etc.
+    // tape_record, tape_replay, tape_stop
     //==================================================================
+    // See "variate tape," above. Each function acts on the tape of
+    // the calling thread's engine for ResultType. tape_status() returns
+    // the tape_mode, and tape_position() returns the number of values
+    // recorded, or replayed, so far.
     template <typename ResultType = int>
-    inline auto rand()
+    inline void tape_record(std::string const& path)
     {
-        static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        return tbx::rr<ResultType>().rand();
+        tbx::rr<ResultType>().tape().record(path);
     }
-    //------------------------------------------------------------------
     template <typename ResultType = int>
-    inline auto rand(ResultType const a, ResultType const b)
+    inline void tape_replay(std::string const& path)
     {
-        static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        return tbx::rr<ResultType>().rand(a, b);
+        tbx::rr<ResultType>().tape().replay(path);
     }
-    //------------------------------------------------------------------
     template <typename ResultType = int>
-    inline auto rand(tbx::param_type<ResultType> const p)
+    inline void tape_stop()
     {
-        static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        return tbx::rr<ResultType>().rand(p);
+        tbx::rr<ResultType>().tape().stop();
     }
-    //------------------------------------------------------------------
     template <typename ResultType = int>
-    inline auto rand_max()
+    inline tbx::tape_mode tape_status()
     {
-        static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        return tbx::rr<ResultType>().rand_max();
+        return tbx::rr<ResultType>().tape().mode();
     }
-    //------------------------------------------------------------------
     template <typename ResultType = int>
-    inline void srand()
+    inline std::size_t tape_position()
     {
-        static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        tbx::rr<ResultType>().srand();  // seed randomly from std::random_device
+        return tbx::rr<ResultType>().tape().position();
     }
+#endif
+
+    //==================================================================
+    // rand(), srand(), etc.
+    //==================================================================
+    // Most of the functions below are declared in tbx.rand.fwd.h,
+    // along with their default template arguments (ResultType = int).
+    // They are not declared inline, so that tbx.rand.cpp can instantiate them
+    // once, for programs that define TBX_RAND_EXTERN_TEMPLATES.
+    static_assert(std::is_same_v<std::mt19937::result_type, std::uint_fast32_t>, "");
     //------------------------------------------------------------------
-    template <typename ResultType = int>
-    inline void srand(typename std::mt19937::result_type const seed)
+    template <typename ResultType>
+    ResultType rand()
     {
         static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        tbx::rr<ResultType>().srand(seed);  // seed from unsigned int
+        return tbx::rr<ResultType>().rand();
     }
     //------------------------------------------------------------------
-    template <typename ResultType = int>
-    inline void srand(std::seed_seq const& sseq)
+    template <typename ResultType>
+    ResultType rand(ResultType const a, ResultType const b)
     {
         static_assert(tbx::is_arithmetic_v<ResultType>, "");
-        tbx::rr<ResultType>().srand(sseq);  // seed from std::seed_seq
+        return tbx::rr<ResultType>().rand(a, b);
     }
     //------------------------------------------------------------------
+    template <typename ResultType = int>
+    ResultType rand(tbx::param_type<ResultType> const p)
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        return tbx::rr<ResultType>().rand(p);
+    }
+    //------------------------------------------------------------------
+    // tbx::rand<bool>(p) returns true with probability p. See
+    // bernoulli_param. Like the functions in the sections that follow,
+    // these overloads are inline, and not instantiated in tbx.rand.cpp.
+    template <typename ResultType>
+    inline std::enable_if_t<std::is_same_v<ResultType, bool>, bool> rand(tbx::bernoulli_param const& p)
+    {
+        return tbx::rr<bool>().rand(p);
+    }
+    template <typename ResultType>
+    inline std::enable_if_t<std::is_same_v<ResultType, bool>, bool> rand(double const p)
+    {
+        return tbx::rr<bool>().rand(tbx::bernoulli_param{ p });
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType>
+    ResultType rand_max()
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        return tbx::rr<ResultType>().rand_max();
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType>
+    void srand()
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        tbx::rr<ResultType>().srand();  // seed randomly from std::random_device
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType>
+    void srand(typename std::mt19937::result_type const seed)
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        tbx::rr<ResultType>().srand(seed);  // seed from unsigned int
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType = int>
+    void srand(std::seed_seq const& sseq)
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        tbx::rr<ResultType>().srand(sseq);  // seed from std::seed_seq
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType, typename SeedSeq, typename>
+    void srand(SeedSeq& sseq)
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        tbx::rr<ResultType>().srand(sseq);  // seed from any seed sequence, e.g., tbx::fixed_seed_seq
+    }
+    //------------------------------------------------------------------
+
+    //==================================================================
+    // detail - engine words and bounded integers
+    //==================================================================
+    namespace detail
+    {
+        // The algorithms that follow draw raw "words" from an engine
+        // and reduce them to the range they need, bypassing
+        // std::uniform_int_distribution. std::mt19937 delivers 32 random
+        // bits per call, so a 64-bit word costs two calls.
+        //
+        // They are constexpr, so that they can also be evaluated at compile
+        // time, with a constexpr engine such as tbx::splitmix64.
+        template <typename URBG>
+        constexpr std::uint32_t word32(URBG& g)
+        {
+            using result_type = typename std::decay_t<URBG>::result_type;
+            static_assert(std::decay_t<URBG>::min() == result_type{ 0u }, "");
+            static_assert(std::decay_t<URBG>::max() >= result_type{ 0xffff'ffffu }, "");
+            return static_cast<std::uint32_t>(g());
+        }
+        //--------------------------------------------------------------
+        template <typename URBG>
+        constexpr std::uint64_t word64(URBG& g, std::true_type)  // 64-bit engine
+        {
+            return static_cast<std::uint64_t>(g());
+        }
+        template <typename URBG>
+        constexpr std::uint64_t word64(URBG& g, std::false_type)  // 32-bit engine
+        {
+            auto const hi{ static_cast<std::uint64_t>(tbx::detail::word32(g)) };
+            return hi << 32 | tbx::detail::word32(g);
+        }
+        template <typename URBG>
+        constexpr std::uint64_t word64(URBG& g)
+        {
+            using engine_type = std::decay_t<URBG>;
+            using is_64_bit = std::integral_constant
+                < bool
+                , engine_type::min() == 0u
+                && engine_type::max() == std::numeric_limits<std::uint64_t>::max()
+                >;
+            return tbx::detail::word64(g, is_64_bit{});
+        }
+        //--------------------------------------------------------------
+        // Full 64 x 64 -> 128-bit product, split into high and low words.
+        struct u128
+        {
+            std::uint64_t hi;
+            std::uint64_t lo;
+        };
+        constexpr u128 mul64(std::uint64_t const a, std::uint64_t const b) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            __extension__ using uint128 = unsigned __int128;
+            auto const p{ static_cast<uint128>(a) * b };
+            return { static_cast<std::uint64_t>(p >> 64), static_cast<std::uint64_t>(p) };
+#else
+            auto const a_lo{ a & 0xffff'ffffu }, a_hi{ a >> 32 };
+            auto const b_lo{ b & 0xffff'ffffu }, b_hi{ b >> 32 };
+            auto const lo_lo{ a_lo * b_lo };
+            auto const hi_lo{ a_hi * b_lo };
+            auto const lo_hi{ a_lo * b_hi };
+            auto const cross{ (lo_lo >> 32) + (hi_lo & 0xffff'ffffu) + lo_hi };
+            return { a_hi * b_hi + (hi_lo >> 32) + (cross >> 32), (cross << 32) | (lo_lo & 0xffff'ffffu) };
+#endif
+        }
+        //--------------------------------------------------------------
+        // Lemire's "nearly divisionless" method: a uniform value on
+        // [0, s), for s > 0. The division (actually, the remainder)
+        // is computed only on the rare occasions when a rejection
+        // might be required.
+        template <typename URBG>
+        constexpr std::uint32_t bounded32(URBG& g, std::uint32_t const s)
+        {
+            auto m{ std::uint64_t{ tbx::detail::word32(g) } * s };
+            if (static_cast<std::uint32_t>(m) < s)
+            {
+                auto const t{ static_cast<std::uint32_t>(0u - s) % s };
+                while (static_cast<std::uint32_t>(m) < t)
+                    m = std::uint64_t{ tbx::detail::word32(g) } * s;
+            }
+            return static_cast<std::uint32_t>(m >> 32);
+        }
+        //--------------------------------------------------------------
+        template <typename URBG>
+        constexpr std::uint64_t bounded64(URBG& g, std::uint64_t const s)
+        {
+            auto m{ tbx::detail::mul64(tbx::detail::word64(g), s) };
+            if (m.lo < s)
+            {
+                auto const t{ (0u - s) % s };
+                while (m.lo < t)
+                    m = tbx::detail::mul64(tbx::detail::word64(g), s);
+            }
+            return m.hi;
+        }
+        //--------------------------------------------------------------
+        // Batched version of bounded64, after Brackett-Rozinsky and
+        // Lemire: K values, each uniform on [0, bound[j]), are carved
+        // out of a single 64-bit word. The product of the bounds must
+        // not exceed 2^64; the smaller it is, the less often a word must
+        // be rejected.
+        template <std::size_t K, typename URBG>
+        inline void bounded64_batch
+        (
+            URBG& g
+            , std::uint64_t const (&bound)[K]
+            , std::uint64_t (&result)[K]
+        )
+        {
+            auto draw = [&]()
+            {
+                auto r{ tbx::detail::word64(g) };
+                for (std::size_t j{}; j < K; ++j)
+                {
+                    auto const m{ tbx::detail::mul64(r, bound[j]) };
+                    result[j] = m.hi;
+                    r = m.lo;
+                }
+                return r;
+            };
+            auto r{ draw() };
+            std::uint64_t product{ 1u };
+            for (auto const b : bound)
+                product *= b;
+            if (r < product)
+            {
+                auto const t{ (0u - product) % product };
+                while (r < t)
+                    r = draw();
+            }
+        }
+    }
+
+    //==================================================================
+    // shuffle
+    //==================================================================
+    // tbx::shuffle(first, last) is a replacement for std::shuffle. It
+    // performs a Fisher-Yates shuffle, drawing from the engine of
+    // thread_local tbx::rr<std::size_t>(). To seed it, call
+    // tbx::srand<std::size_t>(seed), or one of the other overloads.
+    //
+    // std::shuffle calls std::uniform_int_distribution once per
+    // element. tbx::shuffle uses batched bounded-random generation
+    // instead: while the range is small enough, several swap indices
+    // are produced from one 64-bit word, with Lemire-style rejection
+    // to keep them unbiased.
+    //
+    // The sequence of permutations differs from that of std::shuffle,
+    // even when both use the same engine and seed.
+    namespace detail
+    {
+        template <typename RandomIt>
+        inline void shuffle_swap(RandomIt first, std::uint64_t const i, std::uint64_t const j, std::true_type)
+        {
+            // Fast path: trivially copyable elements are exchanged with
+            // plain copies.
+            using difference_type = typename std::iterator_traits<RandomIt>::difference_type;
+            auto& a{ first[static_cast<difference_type>(i)] };
+            auto& b{ first[static_cast<difference_type>(j)] };
+            auto const t{ a };
+            a = b;
+            b = t;
+        }
+        template <typename RandomIt>
+        inline void shuffle_swap(RandomIt first, std::uint64_t const i, std::uint64_t const j, std::false_type)
+        {
+            // Everything else goes through std::iter_swap, so that a
+            // user-defined swap is found.
+            using difference_type = typename std::iterator_traits<RandomIt>::difference_type;
+            std::iter_swap(first + static_cast<difference_type>(i), first + static_cast<difference_type>(j));
+        }
+        //--------------------------------------------------------------
+        // Perform K steps of the shuffle, exchanging elements n - 1,
+        // n - 2, ..., n - K with randomly selected elements that precede
+        // them. Return the new value of n.
+        template <std::size_t K, typename RandomIt, typename URBG>
+        inline std::uint64_t shuffle_steps(RandomIt first, std::uint64_t const n, URBG& g)
+        {
+            using traits = std::iterator_traits<RandomIt>;
+            using is_fast = std::integral_constant
+                < bool
+                , std::is_trivially_copyable<typename traits::value_type>::value
+                && std::is_lvalue_reference<typename traits::reference>::value
+                >;
+            std::uint64_t bound[K], index[K];
+            for (std::size_t j{}; j < K; ++j)
+                bound[j] = n - j;
+            tbx::detail::bounded64_batch(g, bound, index);
+            for (std::size_t j{}; j < K; ++j)
+                tbx::detail::shuffle_swap(first, n - 1u - j, index[j], is_fast{});
+            return n - K;
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename RandomIt, typename URBG>
+    inline void shuffle(RandomIt first, RandomIt last, URBG&& g)
+    {
+        using iterator_category = typename std::iterator_traits<RandomIt>::iterator_category;
+        static_assert(std::is_base_of<std::random_access_iterator_tag, iterator_category>::value, "");
+        if (!(first < last))
+            return;
+        auto n{ static_cast<std::uint64_t>(last - first) };
+
+        // Batch sizes are chosen so that the product of the bounds
+        // in a batch never exceeds 2^60. That keeps rejections rare.
+        while (n > (std::uint64_t{ 1u } << 30))
+            n = tbx::detail::shuffle_steps<1u>(first, n, g);
+        while (n > (std::uint64_t{ 1u } << 20))
+            n = tbx::detail::shuffle_steps<2u>(first, n, g);
+        while (n > (std::uint64_t{ 1u } << 15))
+            n = tbx::detail::shuffle_steps<3u>(first, n, g);
+        while (n > (std::uint64_t{ 1u } << 12))
+            n = tbx::detail::shuffle_steps<4u>(first, n, g);
+        while (n > (std::uint64_t{ 1u } << 10))
+            n = tbx::detail::shuffle_steps<5u>(first, n, g);
+        while (n > 6u)
+            n = tbx::detail::shuffle_steps<6u>(first, n, g);
+        while (n > 1u)
+            n = tbx::detail::shuffle_steps<1u>(first, n, g);
+    }
+    //------------------------------------------------------------------
+    template <typename RandomIt>
+    inline void shuffle(RandomIt first, RandomIt last)
+    {
+        tbx::shuffle(first, last, tbx::rr<std::size_t>().urbg());
+    }
+
+    //==================================================================
+    // sample_indices
+    //==================================================================
+    // tbx::sample_indices(first, last, n) fills the caller's buffer
+    // [first, last) with k = last - first distinct indices, selected
+    // at random from the range [0, n). Like tbx::shuffle, it draws
+    // from the engine of thread_local tbx::rr<std::size_t>().
+    //
+    // Nothing is allocated. The algorithm is chosen according to k/n:
+    //
+    //    sorted == true    Vitter's Method D, which skips over the
+    //                       records that are not selected, and writes
+    //                       the sample in ascending order.
+    //
+    //    k small vs. n     Floyd's algorithm, with a small open-
+    //                       addressing set on the stack. When k is too
+    //                       big for that set, Method D is used instead.
+    //
+    //    k large vs. n     A partial Fisher-Yates shuffle, which runs
+    //                       "inside out," so that only the first k
+    //                       elements of the permutation are stored.
+    //
+    // When sorted == false, the sample is delivered in random order.
+    namespace detail
+    {
+        // A double on the open interval (0, 1), for use with log().
+        template <typename URBG>
+        inline double uniform_open01(URBG& g)
+        {
+            auto const w{ tbx::detail::word64(g) >> 11 };
+            return (static_cast<double>(w) + 0.5) * (1.0 / 9'007'199'254'740'992.0);  // 2^53
+        }
+        //--------------------------------------------------------------
+        // A uniform value on [0, s), using a single 32-bit word when
+        // that is enough.
+        template <typename URBG>
+        inline std::uint64_t bounded(URBG& g, std::uint64_t const s)
+        {
+            return s <= 0xffff'ffffu
+                ? tbx::detail::bounded32(g, static_cast<std::uint32_t>(s))
+                : tbx::detail::bounded64(g, s);
+        }
+        //--------------------------------------------------------------
+        template <typename RandomIt>
+        inline void sample_put(RandomIt first, std::uint64_t const i, std::uint64_t const index)
+        {
+            using traits = std::iterator_traits<RandomIt>;
+            first[static_cast<typename traits::difference_type>(i)]
+                = static_cast<typename traits::value_type>(index);
+        }
+        //--------------------------------------------------------------
+        // Vitter, J. S. (1984), "Faster Methods for Random Sampling,"
+        // Method A. It is used for the final few records of Method D,
+        // once the number remaining is small relative to the sample.
+        template <typename RandomIt, typename URBG>
+        inline void sample_method_a
+        (
+            RandomIt first
+            , std::uint64_t i          // next position in the output
+            , std::uint64_t position   // next record that can be selected
+            , std::uint64_t N          // number of records remaining
+            , std::uint64_t n          // number still to select
+            , URBG& g
+        )
+        {
+            auto top{ static_cast<double>(N - n) };
+            auto N_real{ static_cast<double>(N) };
+            while (n >= 2u)
+            {
+                auto const V{ tbx::detail::uniform_open01(g) };
+                std::uint64_t S{};
+                auto quot{ top / N_real };
+                while (quot > V)
+                {
+                    ++S;
+                    top -= 1.0;
+                    N_real -= 1.0;
+                    quot = (quot * top) / N_real;
+                }
+                position += S;
+                tbx::detail::sample_put(first, i++, position++);
+                N_real -= 1.0;
+                --n;
+            }
+            auto const remaining{ static_cast<std::uint64_t>(N_real + 0.5) };
+            auto const S{ static_cast<std::uint64_t>(N_real * tbx::detail::uniform_open01(g)) };
+            tbx::detail::sample_put(first, i, position + (S < remaining ? S : remaining - 1u));
+        }
+        //--------------------------------------------------------------
+        // Vitter, J. S. (1987), "An Efficient Algorithm for Sequential
+        // Random Sampling," Method D. Select n of N records, in order.
+        template <typename RandomIt, typename URBG>
+        inline void sample_method_d(RandomIt first, std::uint64_t N, std::uint64_t n, URBG& g)
+        {
+            double constexpr alpha_inverse{ 13.0 };  // Vitter's recommended value
+            auto uniform_root = [&g](double const inverse) {
+                return std::exp(std::log(tbx::detail::uniform_open01(g)) * inverse);
+            };
+            std::uint64_t i{}, position{};
+            auto n_real{ static_cast<double>(n) };
+            auto N_real{ static_cast<double>(N) };
+            auto n_inverse{ 1.0 / n_real };
+            auto v_prime{ uniform_root(n_inverse) };
+            auto qu1{ N - n + 1u };
+            auto qu1_real{ N_real - n_real + 1.0 };
+            auto threshold{ alpha_inverse * n_real };
+            while (n > 1u && threshold < N_real)
+            {
+                auto const n_min1_inverse{ 1.0 / (n_real - 1.0) };
+                std::uint64_t S;
+                for (;;)
+                {
+                    // Step D2: generate U and X.
+                    double X;
+                    for (;;)
+                    {
+                        X = N_real * (1.0 - v_prime);
+                        S = static_cast<std::uint64_t>(X);
+                        if (S < qu1)
+                            break;
+                        v_prime = uniform_root(n_inverse);
+                    }
+                    auto const U{ tbx::detail::uniform_open01(g) };
+                    auto const S_real{ static_cast<double>(S) };
+                    auto const y1{ std::exp(std::log(U * N_real / qu1_real) * n_min1_inverse) };
+                    v_prime = y1 * (1.0 - X / N_real) * (qu1_real / (qu1_real - S_real));
+
+                    // Step D3: accept S?
+                    if (v_prime <= 1.0)
+                        break;
+
+                    // Step D4: accept S after all?
+                    auto y2{ 1.0 };
+                    auto top{ N_real - 1.0 };
+                    double bottom;
+                    std::uint64_t limit;
+                    if (n - 1u > S)
+                    {
+                        bottom = N_real - n_real;
+                        limit = N - S;
+                    }
+                    else
+                    {
+                        bottom = N_real - S_real - 1.0;
+                        limit = qu1;
+                    }
+                    for (auto t{ N - 1u }; t >= limit; --t)
+                    {
+                        y2 = (y2 * top) / bottom;
+                        top -= 1.0;
+                        bottom -= 1.0;
+                    }
+                    if (N_real / (N_real - X) >= y1 * std::exp(std::log(y2) * n_min1_inverse))
+                    {
+                        v_prime = uniform_root(n_min1_inverse);
+                        break;
+                    }
+                    v_prime = uniform_root(n_inverse);
+                }
+                // Skip S records, and select the one after them.
+                position += S;
+                tbx::detail::sample_put(first, i++, position++);
+                N -= S + 1u;
+                N_real -= static_cast<double>(S) + 1.0;
+                --n;
+                n_real -= 1.0;
+                n_inverse = n_min1_inverse;
+                qu1 -= S;
+                qu1_real -= static_cast<double>(S);
+                threshold -= alpha_inverse;
+            }
+            if (n > 1u)
+            {
+                tbx::detail::sample_method_a(first, i, position, N, n, g);
+            }
+            else
+            {
+                auto const S{ static_cast<std::uint64_t>(N_real * v_prime) };
+                tbx::detail::sample_put(first, i, position + (S < N ? S : N - 1u));
+            }
+        }
+        //--------------------------------------------------------------
+        // Floyd's algorithm: for j = n - k, ..., n - 1, select a random
+        // t on [0, j]. If t has already been selected, select j instead.
+        // Return false, without touching the output, when k is too big
+        // for the set.
+        template <typename RandomIt, typename URBG>
+        inline bool sample_floyd(RandomIt first, std::uint64_t const n, std::uint64_t const k, URBG& g)
+        {
+            enum : std::size_t { log2_table_size = 11u, table_size = std::size_t{ 1u } << log2_table_size };
+            if (k > table_size / 2u)
+                return false;
+            auto constexpr empty{ std::numeric_limits<std::uint64_t>::max() };
+            std::uint64_t table[table_size];
+            for (auto& slot : table)
+                slot = empty;
+            auto insert = [&table](std::uint64_t const key)
+            {
+                // Fibonacci hashing, with linear probing.
+                auto slot{ static_cast<std::size_t>((key * 0x9e37'79b9'7f4a'7c15u) >> (64u - log2_table_size)) };
+                while (table[slot] != empty)
+                {
+                    if (table[slot] == key)
+                        return false;
+                    slot = (slot + 1u) & (table_size - 1u);
+                }
+                table[slot] = key;
+                return true;
+            };
+            std::uint64_t i{};
+            for (auto j{ n - k }; j < n; ++j)
+            {
+                auto const t{ tbx::detail::bounded(g, j + 1u) };
+                auto const selected{ insert(t) ? t : j };
+                if (selected != t)
+                    insert(j);
+                tbx::detail::sample_put(first, i++, selected);
+            }
+            return true;
+        }
+        //--------------------------------------------------------------
+        // Inside-out Fisher-Yates, truncated to the first k elements.
+        // Elements at positions k and higher are never read, so they
+        // need not be stored.
+        template <typename RandomIt, typename URBG>
+        inline void sample_fisher_yates(RandomIt first, std::uint64_t const n, std::uint64_t const k, URBG& g)
+        {
+            using traits = std::iterator_traits<RandomIt>;
+            auto at = [first](std::uint64_t const i) -> decltype(auto) {
+                return first[static_cast<typename traits::difference_type>(i)];
+            };
+            for (std::uint64_t i{}; i < n; ++i)
+            {
+                auto const j{ tbx::detail::bounded(g, i + 1u) };
+                if (i < k)
+                {
+                    at(i) = at(j);
+                    tbx::detail::sample_put(first, j, i);
+                }
+                else if (j < k)
+                {
+                    tbx::detail::sample_put(first, j, i);
+                }
+            }
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename RandomIt>
+    inline void sample_indices(RandomIt first, RandomIt last, std::uint64_t const n, bool const sorted = false)
+    {
+        using traits = std::iterator_traits<RandomIt>;
+        using value_type = typename traits::value_type;
+        static_assert(std::is_base_of<std::random_access_iterator_tag, typename traits::iterator_category>::value, "");
+        static_assert(std::is_integral_v<value_type>, "");
+        if (!(first < last))
+            return;
+        auto const k{ static_cast<std::uint64_t>(last - first) };
+        if (n < k)
+            throw std::invalid_argument(
+                "tbx::sample_indices(first, last, n): "
+                "cannot select more than n indices");
+        if (static_cast<std::uint64_t>(std::numeric_limits<value_type>::max()) < n - 1u)
+            throw std::invalid_argument(
+                "tbx::sample_indices(first, last, n): "
+                "value_type of the output range cannot hold index n - 1");
+        auto& g{ tbx::rr<std::size_t>().urbg() };
+        if (sorted)
+        {
+            tbx::detail::sample_method_d(first, n, k, g);
+        }
+        else if (k >= n / 4u)
+        {
+            tbx::detail::sample_fisher_yates(first, n, k, g);
+        }
+        else
+        {
+            // Floyd's algorithm and Method D both select a random subset,
+            // but not in random order. A shuffle takes care of that.
+            if (!tbx::detail::sample_floyd(first, n, k, g))
+                tbx::detail::sample_method_d(first, n, k, g);
+            tbx::shuffle(first, last, g);
+        }
+    }
+
+    //==================================================================
+    // random_permutation
+    //==================================================================
+    // A random_permutation is a bijection on the index space [0, n),
+    // which can be evaluated at any index in O(1) time, using O(1)
+    // memory. It lets you visit every element of an enormous key space
+    // in random order, without materializing a permutation array.
+    //
+    // The mapping is a balanced Feistel network, keyed by std::mt19937.
+    // Each round function is a 32-bit integer hash. When n is not an
+    // even power of two, the network runs on the next even power of
+    // two, and "cycle walking" carries values that fall outside [0, n)
+    // back into it. On average, fewer than four passes through the
+    // network are needed. n must be positive: an empty index space
+    // throws std::invalid_argument.
+    //
+    // The keys are set by srand(), which follows the conventions of
+    // tbx::srand():
+    //
+    //    srand(seed)       seed the key generator with an unsigned int
+    //    srand()           seed it using std::random_device
+    //    srand(seed_seq)   seed it using a seed sequence
+    //
+    // A permutation that has not been seeded behaves as if srand(1u)
+    // had been called.
+    //
+    // random_permutation is immutable once seeded, and may be shared
+    // by any number of threads. Use slice(first, last) to let each
+    // thread iterate over its own part of the permutation.
+    class random_permutation
+    {
+    public:
+        using size_type = std::uint64_t;
+        using seed_type = typename std::mt19937::result_type;
+        auto static constexpr const default_seed{ seed_type{1u} };
+    private:
+        enum : std::size_t { n_rounds = 6u, batch_size = 8u };
+        size_type n_{};
+        std::uint32_t half_bits_{};
+        std::uint32_t half_mask_{};
+        std::array<std::uint32_t, n_rounds> keys_{};
+    public:
+        class iterator
+        {
+            random_permutation const* p_{};
+            size_type i_{};
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = size_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const*;
+            using reference = value_type;
+            iterator() noexcept
+                = default;
+            iterator(random_permutation const& p, size_type const i) noexcept
+                : p_{ &p }, i_{ i }
+            {}
+            value_type operator*() const  { return (*p_)[i_]; }
+            size_type index() const       { return i_; }
+            iterator& operator++()        { ++i_; return *this; }
+            iterator operator++(int)      { auto const t{ *this }; ++i_; return t; }
+            friend bool operator==(iterator const& a, iterator const& b) { return a.i_ == b.i_ && a.p_ == b.p_; }
+            friend bool operator!=(iterator const& a, iterator const& b) { return !(a == b); }
+        };
+        class range
+        {
+            iterator first_, last_;
+        public:
+            range(iterator const first, iterator const last) noexcept
+                : first_{ first }, last_{ last }
+            {}
+            iterator begin() const { return first_; }
+            iterator end() const   { return last_; }
+        };
+        //--------------------------------------------------------------
+        explicit random_permutation(size_type const n, seed_type const seed = default_seed)
+            : n_{ n }
+        {
+            // With no index in [0, n), cycle walking would never end.
+            if (n == 0u)
+                throw std::invalid_argument(
+                    "tbx::random_permutation::random_permutation(n, seed): "
+                    "requires n > 0");
+            std::uint32_t bits{ 2u };
+            while (bits < 64u && (size_type{ 1u } << bits) < n)
+                bits += 2u;
+            half_bits_ = bits / 2u;
+            half_mask_ = static_cast<std::uint32_t>((size_type{ 1u } << half_bits_) - 1u);
+            srand(seed);
+        }
+        //--------------------------------------------------------------
+        void srand(seed_type const seed)  { std::mt19937 eng{ seed }; set_keys(eng); }
+        void srand()                      { tbx::seed_seq_rd s; std::mt19937 eng{ s }; set_keys(eng); }
+        template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+        void srand(SeedSeq& sseq)         { std::mt19937 eng{ sseq }; set_keys(eng); }
+        //--------------------------------------------------------------
+        size_type size() const noexcept   { return n_; }
+        iterator begin() const noexcept   { return iterator{ *this, 0u }; }
+        iterator end() const noexcept     { return iterator{ *this, n_ }; }
+        range slice(size_type const first, size_type const last) const
+        {
+            if (last < first || n_ < last)
+                throw std::invalid_argument(
+                    "tbx::random_permutation::slice(first, last): "
+                    "requires first <= last <= size()");
+            return range{ iterator{ *this, first }, iterator{ *this, last } };
+        }
+        //--------------------------------------------------------------
+        size_type operator[](size_type const i) const
+        {
+            auto x{ encrypt(i) };
+            while (x >= n_)  // cycle walking
+                x = encrypt(x);
+            return x;
+        }
+        //--------------------------------------------------------------
+        // Map a batch of indices. The Feistel rounds are applied to
+        // batch_size indices at a time, in lockstep, in loops the
+        // compiler can vectorize. Cycle walking is handled afterwards,
+        // one index at a time.
+        template <typename InputIt, typename OutputIt>
+        OutputIt map(InputIt first, InputIt last, OutputIt out) const
+        {
+            // The rounds run on all batch_size lanes, even for a partial
+            // batch, so the unused lanes must hold values.
+            std::uint32_t lo[batch_size]{}, hi[batch_size]{};
+            while (first != last)
+            {
+                std::size_t count{};
+                for (; count < batch_size && first != last; ++count, ++first)
+                {
+                    auto const i{ static_cast<size_type>(*first) };
+                    lo[count] = static_cast<std::uint32_t>(i) & half_mask_;
+                    hi[count] = static_cast<std::uint32_t>(i >> half_bits_);
+                }
+                for (auto const key : keys_)
+                {
+                    for (std::size_t j{}; j < batch_size; ++j)
+                    {
+                        auto const t{ hi[j] ^ (round(lo[j], key) & half_mask_) };
+                        hi[j] = lo[j];
+                        lo[j] = t;
+                    }
+                }
+                for (std::size_t j{}; j < count; ++j)
+                {
+                    auto x{ size_type{ hi[j] } << half_bits_ | lo[j] };
+                    while (x >= n_)
+                        x = encrypt(x);
+                    *out++ = x;
+                }
+            }
+            return out;
+        }
+    private:
+        template <typename URBG>
+        void set_keys(URBG& eng)
+        {
+            for (auto& key : keys_)
+                key = static_cast<std::uint32_t>(eng());
+        }
+        static std::uint32_t round(std::uint32_t x, std::uint32_t const key) noexcept
+        {
+            // "lowbias32," an integer hash by Chris Wellons
+            x ^= key;
+            x ^= x >> 16;
+            x *= 0x7feb'352du;
+            x ^= x >> 15;
+            x *= 0x846c'a68bu;
+            x ^= x >> 16;
+            return x;
+        }
+        size_type encrypt(size_type const i) const noexcept
+        {
+            auto lo{ static_cast<std::uint32_t>(i) & half_mask_ };
+            auto hi{ static_cast<std::uint32_t>(i >> half_bits_) };
+            for (auto const key : keys_)
+            {
+                auto const t{ hi ^ (round(lo, key) & half_mask_) };
+                hi = lo;
+                lo = t;
+            }
+            return size_type{ hi } << half_bits_ | lo;
+        }
+    };
+
+    //==================================================================
+    // detail - bulk generation
+    //==================================================================
+    namespace detail
+    {
+        // Bulk generation runs in three passes over a block: draw raw
+        // words from the engine; reduce or convert them, in a loop with
+        // no branches, that the compiler can vectorize; and finally,
+        // redraw the rare values that Lemire's method rejects. The
+        // second pass is a bulk kernel. See bulk_isa.
+        enum : std::size_t { bulk_block_size = 256u };
+        //--------------------------------------------------------------
+        template <typename URBG>
+        inline void fill_words(URBG& g, std::uint32_t* const words, std::size_t const n)
+        {
+            for (std::size_t i{}; i < n; ++i)
+                words[i] = tbx::detail::word32(g);
+        }
+        template <typename URBG>
+        inline void fill_words(URBG& g, std::uint64_t* const words, std::size_t const n)
+        {
+            for (std::size_t i{}; i < n; ++i)
+                words[i] = tbx::detail::word64(g);
+        }
+        //--------------------------------------------------------------
+        // Lemire's reduction of 32-bit words to [base, base + s): the
+        // high half of each product goes to dest, and the low half,
+        // which decides rejection, replaces the word. Return the
+        // least low half.
+        template <typename T>
+        struct multiply_high_kernel
+        {
+            bool static constexpr const floating_point{ false };
+            TBX_RAND_KERNEL_BODY
+            static std::uint32_t body(std::uint32_t* const words, T* const dest, std::size_t const n
+                , std::uint32_t const s, std::uint64_t const base) noexcept
+            {
+                std::uint32_t low_min{ ~std::uint32_t{} };
+                for (std::size_t i{}; i < n; ++i)
+                {
+                    auto const m{ std::uint64_t{ words[i] } * s };
+                    words[i] = static_cast<std::uint32_t>(m);
+                    low_min = words[i] < low_min ? words[i] : low_min;
+                    dest[i] = static_cast<T>(base + (m >> 32));
+                }
+                return low_min;
+            }
+        };
+        //--------------------------------------------------------------
+        // Conversion of words to [a, b), using the high-order bits of
+        // each word that fit the significand of T
+        template <typename T, typename Word>
+        struct word_to_real_kernel
+        {
+            bool static constexpr const floating_point{ true };
+            TBX_RAND_KERNEL_BODY
+            static void body(Word const* const words, T* const dest, std::size_t const n
+                , T const a, T const b, T const scale, T const below_b) noexcept
+            {
+                int constexpr word_bits{ std::numeric_limits<Word>::digits };
+                int constexpr digits{ std::numeric_limits<T>::digits };
+                int constexpr shift{ digits < word_bits ? word_bits - digits : 0 };
+                auto const width{ b - a };
+                for (std::size_t i{}; i < n; ++i)
+                {
+                    // Rounding can carry a + u * (b - a) up to b, which
+                    // is outside the range.
+                    auto const x{ a + static_cast<T>(words[i] >> shift) * scale * width };
+                    dest[i] = x < b ? x : below_b;
+                }
+            }
+        };
+        //--------------------------------------------------------------
+        // Integral values on the closed range [a, b]
+        template <typename T, typename URBG>
+        inline void generate_block(URBG& g, T* const out, std::size_t const n, T const a, T const b, std::true_type)
+        {
+            auto const base{ static_cast<std::uint64_t>(a) };
+            auto const range{ static_cast<std::uint64_t>(b) - base };
+            std::size_t done{};
+            while (done < n)
+            {
+                auto const count{ n - done < bulk_block_size ? n - done : std::size_t{ bulk_block_size } };
+                auto* const dest{ out + done };
+                if (range < 0xffff'ffffu)
+                {
+                    std::uint32_t words[bulk_block_size];
+                    tbx::detail::fill_words(g, words, count);
+                    auto const s{ static_cast<std::uint32_t>(range + 1u) };
+                    auto const low_min{ tbx::detail::dispatch<tbx::detail::multiply_high_kernel<T>>(
+                        &words[0], dest, count, s, base) };
+                    if (low_min < s)
+                    {
+                        auto const t{ static_cast<std::uint32_t>(0u - s) % s };
+                        for (std::size_t i{}; i < count; ++i)
+                            if (words[i] < t)
+                                dest[i] = static_cast<T>(base + tbx::detail::bounded32(g, s));
+                    }
+                }
+                else if (range == 0xffff'ffffu)
+                {
+                    for (std::size_t i{}; i < count; ++i)
+                        dest[i] = static_cast<T>(base + tbx::detail::word32(g));
+                }
+                else if (range == ~std::uint64_t{})
+                {
+                    for (std::size_t i{}; i < count; ++i)
+                        dest[i] = static_cast<T>(tbx::detail::word64(g));
+                }
+                else
+                {
+                    for (std::size_t i{}; i < count; ++i)
+                        dest[i] = static_cast<T>(base + tbx::detail::bounded64(g, range + 1u));
+                }
+                done += count;
+            }
+        }
+        //--------------------------------------------------------------
+        // Floating-point values on the half-open range [a, b). A float
+        // is made from a 32-bit word, and anything wider from a 64-bit
+        // word, using as many high-order bits as the significand holds.
+        template <typename T, typename URBG>
+        inline void generate_block(URBG& g, T* const out, std::size_t const n, T const a, T const b, std::false_type)
+        {
+            using word_type = std::conditional_t<sizeof(T) <= 4u, std::uint32_t, std::uint64_t>;
+            int constexpr word_bits{ std::numeric_limits<word_type>::digits };
+            int constexpr digits{ std::numeric_limits<T>::digits };
+            int constexpr shift{ digits < word_bits ? word_bits - digits : 0 };
+            auto const scale{ std::ldexp(T{ 1 }, shift - word_bits) };
+            auto const below_b{ std::nextafter(b, a) };
+            std::size_t done{};
+            while (done < n)
+            {
+                auto const count{ n - done < bulk_block_size ? n - done : std::size_t{ bulk_block_size } };
+                auto* const dest{ out + done };
+                word_type words[bulk_block_size];
+                tbx::detail::fill_words(g, words, count);
+                tbx::detail::dispatch<tbx::detail::word_to_real_kernel<T, word_type>>(
+                    static_cast<word_type const*>(words), dest, count, a, b, scale, below_b);
+                done += count;
+            }
+        }
+    }
+
+    //==================================================================
+    // rand_range, rand_iterator
+    //==================================================================
+    // A rand_range<ResultType> is an endless input range of random
+    // values. Its iterators, of type rand_iterator<ResultType>, can be
+    // handed to std::copy_n, std::transform, and other algorithms that
+    // consume input iterators.
+    //
+    // A rand_range looks up the thread_local engine of the calling
+    // thread once, when it is constructed, and refills an internal
+    // block of 256 variates at a time, using the bulk generation
+    // routines above. That amortizes the cost of calling rand() once
+    // per element.
+    //
+    // The constructors mirror the overloads of tbx::rand():
+    //
+    //    rand_range<ResultType>()       same range as rand<ResultType>()
+    //    rand_range<ResultType>(a, b)   same range as rand<ResultType>(a, b)
+    //    rand_range<ResultType>(param)  same range as rand<ResultType>(param)
+    //
+    // The values are drawn from the same engine as rand<ResultType>(),
+    // and have the same distribution, but they are not the same values
+    // that repeated calls to rand<ResultType>() would produce.
+    //
+    // A rand_range must be used only in the thread that constructed
+    // it, and it must outlive its iterators.
+    template <typename ResultType>
+    class rand_range;
+
+    template <typename ResultType>
+    class rand_iterator
+    {
+        tbx::rand_range<ResultType>* r_{};
+        class postfix_proxy
+        {
+            ResultType value_;
+        public:
+            explicit postfix_proxy(ResultType const value) noexcept
+                : value_{ value }
+            {}
+            ResultType operator*() const noexcept { return value_; }
+        };
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ResultType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+        rand_iterator() noexcept
+            = default;
+        explicit rand_iterator(tbx::rand_range<ResultType>& r) noexcept
+            : r_{ &r }
+        {}
+        reference operator*() const     { return r_->current(); }
+        pointer operator->() const      { return &r_->current(); }
+        rand_iterator& operator++()     { r_->advance(); return *this; }
+        postfix_proxy operator++(int) { postfix_proxy const p{ **this }; r_->advance(); return p; }
+
+        // The range is endless: only an end iterator equals an end iterator.
+        friend bool operator==(rand_iterator const& a, rand_iterator const& b) noexcept { return a.r_ == b.r_; }
+        friend bool operator!=(rand_iterator const& a, rand_iterator const& b) noexcept { return !(a == b); }
+    };
+
+    template <typename ResultType>
+    class rand_range
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+    public:
+        using result_type = ResultType;
+        using param_type = tbx::param_type<ResultType>;
+        using iterator = tbx::rand_iterator<ResultType>;
+    private:
+        friend class tbx::rand_iterator<ResultType>;
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        tbx::rand_replacement<ResultType>& r_;
+        result_type a_;
+        result_type b_;
+        std::size_t next_{ block_size };
+        std::array<result_type, block_size> block_;
+    public:
+        rand_range()
+            : rand_range(result_type{}, std::is_floating_point_v<result_type>
+                ? result_type{ 1 }
+                : std::numeric_limits<result_type>::max())
+        {}
+        rand_range(result_type const a, result_type const b)
+            : r_{ tbx::rr<ResultType>() }
+            , a_{ b < a ? b : a }
+            , b_{ b < a ? a : b }
+        {
+            if (std::is_floating_point_v<result_type> && !(a_ < b_))
+                throw std::invalid_argument(
+                    "tbx::rand_range<ResultType>::rand_range(a, b): "
+                    "floating-point arguments require a != b");
+        }
+        explicit rand_range(param_type const& p)
+            : rand_range(check(p.a()), check(p.b()))
+        {}
+        rand_range(rand_range const&)
+            = delete;
+        rand_range& operator=(rand_range const&)
+            = delete;
+        iterator begin()            { return iterator{ *this }; }
+        iterator end() noexcept     { return iterator{}; }
+    private:
+        result_type const& current()
+        {
+            if (next_ == block_size)
+                refill();
+            return block_[next_];
+        }
+        void advance()
+        {
+            if (next_ == block_size)
+                refill();
+            ++next_;
+        }
+        void refill()
+        {
+            using is_integral = std::integral_constant<bool, tbx::is_integral_v<result_type>>;
+            tbx::detail::generate_block(r_.urbg(), block_.data(), block_size, a_, b_, is_integral{});
+            next_ = 0u;
+        }
+        template <typename T>
+        auto static check(T const x)
+        {
+            if (x < static_cast<T>(std::numeric_limits<result_type>::lowest())
+                || static_cast<T>(std::numeric_limits<result_type>::max()) < x)
+                throw std::invalid_argument(
+                    "tbx::rand_range<ResultType>::rand_range(param): "
+                    "param out of range for ResultType");
+            return static_cast<result_type>(x);
+        }
+    };
+
+    //==================================================================
+    // charset, rand_string
+    //==================================================================
+    // tbx::rand_string(dst, len, cs) writes len characters, selected at
+    // random from charset cs, to the output iterator dst. It is meant
+    // for IDs, tokens, and test data. The engine is the one used by
+    // tbx::rand<ResultType>(), so tbx::srand<ResultType>() makes the
+    // strings reproducible. ResultType defaults to char.
+    //
+    // A charset holds up to 256 characters. Several are predefined:
+    //
+    //    tbx::charsets::hex               0-9 a-f
+    //    tbx::charsets::base32            A-Z 2-7 (RFC 4648)
+    //    tbx::charsets::base62            0-9 A-Z a-z
+    //    tbx::charsets::base64url         A-Z a-z 0-9 - _ (RFC 4648)
+    //    tbx::charsets::printable_ascii   '!' through '~'
+    //
+    // When the size of a charset is a power of two, each 64-bit word
+    // from the engine is cut into as many characters as it holds, and
+    // each chunk of bits indexes the charset directly. Sixteen-character
+    // charsets use a pshufb table lookup, when SSSE3 is available. For
+    // other sizes, a single bounded 32-bit value is drawn for a "pack"
+    // of characters, whose digits, in base size(), select characters.
+    class charset
+    {
+        std::array<char, 256> chars_{};
+        std::uint32_t size_{};
+        std::uint32_t bits_{};        // log2(size_), when size_ is a power of two
+        std::uint32_t pack_size_{};   // characters per 32-bit value, otherwise
+        std::uint32_t pack_bound_{};  // size_ raised to the power pack_size_
+        bool is_power_of_two_{};
+    public:
+        constexpr explicit charset(std::string_view const chars)
+        {
+            if (chars.empty() || chars_.size() < chars.size())
+                throw std::invalid_argument(
+                    "tbx::charset::charset(chars): "
+                    "requires 1 to 256 characters");
+            size_ = static_cast<std::uint32_t>(chars.size());
+            for (std::uint32_t i{}; i < size_; ++i)
+                chars_[i] = chars[i];
+            is_power_of_two_ = (size_ & (size_ - 1u)) == 0u;
+            while ((std::uint32_t{ 1u } << bits_) < size_)
+                ++bits_;
+            std::uint64_t bound{ size_ };
+            pack_size_ = 1u;
+            while (!is_power_of_two_ && bound * size_ <= 0xffff'ffffu)
+            {
+                bound *= size_;
+                ++pack_size_;
+            }
+            pack_bound_ = static_cast<std::uint32_t>(bound);
+        }
+        constexpr std::size_t size() const noexcept             { return size_; }
+        constexpr char operator[](std::size_t const i) const    { return chars_[i]; }
+        constexpr char const* data() const noexcept             { return chars_.data(); }
+        constexpr bool is_power_of_two() const noexcept         { return is_power_of_two_; }
+        constexpr std::uint32_t bits() const noexcept           { return bits_; }
+        constexpr std::uint32_t pack_size() const noexcept      { return pack_size_; }
+        constexpr std::uint32_t pack_bound() const noexcept     { return pack_bound_; }
+    };
+    //------------------------------------------------------------------
+    namespace charsets
+    {
+        inline constexpr tbx::charset hex{ "0123456789abcdef" };
+        inline constexpr tbx::charset base32{ "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567" };
+        inline constexpr tbx::charset base62{
+            "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz" };
+        inline constexpr tbx::charset base64url{
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" };
+        inline constexpr tbx::charset printable_ascii{
+            "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+            "[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~" };
+    }
+    //------------------------------------------------------------------
+    namespace detail
+    {
+#if defined(__SSSE3__)
+        // 32 characters from a 16-character charset, per 128 bits drawn
+        template <typename URBG>
+        inline char* rand_string_ssse3(URBG& g, char* dst, std::size_t const n_blocks, tbx::charset const& cs)
+        {
+            auto const table{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(cs.data())) };
+            auto const low_nibbles{ _mm_set1_epi8(0x0f) };
+            for (auto i{ n_blocks }; i--; dst += 32)
+            {
+                auto const lo{ tbx::detail::word64(g) };
+                auto const hi{ tbx::detail::word64(g) };
+                auto const w{ _mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo)) };
+                auto const a{ _mm_shuffle_epi8(table, _mm_and_si128(w, low_nibbles)) };
+                auto const b{ _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(w, 4), low_nibbles)) };
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(a, b));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi8(a, b));
+            }
+            return dst;
+        }
+#endif
+        //--------------------------------------------------------------
+        template <typename OutputIt, typename URBG>
+        inline OutputIt rand_string_power_of_two(URBG& g, OutputIt dst, std::size_t len, tbx::charset const& cs)
+        {
+            auto const bits{ cs.bits() };
+            if (bits == 0u)
+            {
+                for (; len; --len)
+                    *dst++ = cs[0];
+                return dst;
+            }
+#if defined(__SSSE3__)
+            if constexpr (std::is_same_v<OutputIt, char*>)
+            {
+                if (bits == 4u)
+                {
+                    dst = tbx::detail::rand_string_ssse3(g, dst, len / 32u, cs);
+                    len %= 32u;
+                }
+            }
+#endif
+            auto const per_word{ 64u / bits };
+            auto const mask{ (std::uint64_t{ 1u } << bits) - 1u };
+            while (len)
+            {
+                auto w{ tbx::detail::word64(g) };
+                for (auto i{ len < per_word ? len : per_word }; i--; --len, w >>= bits)
+                    *dst++ = cs[static_cast<std::size_t>(w & mask)];
+            }
+            return dst;
+        }
+        //--------------------------------------------------------------
+        template <typename OutputIt, typename URBG>
+        inline OutputIt rand_string_packed(URBG& g, OutputIt dst, std::size_t len, tbx::charset const& cs)
+        {
+            auto const size{ static_cast<std::uint32_t>(cs.size()) };
+            while (len)
+            {
+                auto x{ tbx::detail::bounded32(g, cs.pack_bound()) };
+                for (auto i{ len < cs.pack_size() ? len : cs.pack_size() }; i--; --len, x /= size)
+                    *dst++ = cs[x % size];
+            }
+            return dst;
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType = char, typename OutputIt>
+    inline OutputIt rand_string(OutputIt dst, std::size_t const len, tbx::charset const& cs)
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        auto& g{ tbx::rr<ResultType>().urbg() };
+        return cs.is_power_of_two()
+            ? tbx::detail::rand_string_power_of_two(g, dst, len, cs)
+            : tbx::detail::rand_string_packed(g, dst, len, cs);
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType = char>
+    inline std::string rand_string(std::size_t const len, tbx::charset const& cs)
+    {
+        std::string s(len, '\0');
+        tbx::rand_string<ResultType>(s.data(), len, cs);
+        return s;
+    }
+
+    //==================================================================
+    // splitmix64, constexpr_rand, constexpr_rand_array
+    //==================================================================
+    // tbx::splitmix64 is a small engine, all of whose members are
+    // constexpr. It is Sebastiano Vigna's SplitMix64: a Weyl sequence,
+    // run through a 64-bit mixing function. It meets the requirements
+    // of a uniform random bit generator, so it can also be used with
+    // the distributions of the Standard Library.
+    //
+    // tbx::constexpr_rand(g, a, b) draws a value from the closed range
+    // [a, b] (integral types) or the half-open range [a, b) (floating-
+    // point types), and tbx::constexpr_rand_array<T, N>(seed, a, b)
+    // fills a std::array with N of them. When the results are stored
+    // in constexpr variables, they are computed by the compiler, and
+    // no work is left for static initialization:
+    //
+    //   constexpr auto salts{ tbx::constexpr_rand_array<std::uint64_t, 64>(42u) };
+    //   constexpr auto jitter{ tbx::constexpr_rand_array<double, 256>(7u, -0.5, 0.5) };
+    //
+    // Without a range, integral types use [0, max], and floating-point
+    // types use [0, 1), the same as tbx::rand<T>().
+    class splitmix64
+    {
+    public:
+        using result_type = std::uint64_t;
+        auto static constexpr const default_seed{ result_type{1u} };
+    private:
+        result_type state_{ default_seed };
+    public:
+        constexpr splitmix64() noexcept
+            = default;
+        constexpr explicit splitmix64(result_type const seed) noexcept
+            : state_{ seed }
+        {}
+        constexpr void seed(result_type const seed) noexcept   { state_ = seed; }
+        static constexpr result_type min() noexcept            { return 0u; }
+        static constexpr result_type max() noexcept            { return ~result_type{}; }
+        constexpr void discard(unsigned long long const z) noexcept
+        {
+            state_ += z * 0x9e37'79b9'7f4a'7c15u;
+        }
+        constexpr result_type operator()() noexcept
+        {
+            return mix(state_ += 0x9e37'79b9'7f4a'7c15u);
+        }
+        // The mixing function, a bijection on 64-bit words, which is also
+        // useful as a hash
+        static constexpr result_type mix(result_type z) noexcept
+        {
+            z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9u;
+            z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11ebu;
+            return z ^ (z >> 31);
+        }
+        friend constexpr bool operator==(splitmix64 const& a, splitmix64 const& b) noexcept { return a.state_ == b.state_; }
+        friend constexpr bool operator!=(splitmix64 const& a, splitmix64 const& b) noexcept { return !(a == b); }
+    };
+    //------------------------------------------------------------------
+    template <typename T, typename URBG>
+    constexpr T constexpr_rand(URBG& g, T a, T b)
+    {
+        static_assert(tbx::is_arithmetic_v<T>, "");
+        if (b < a)
+        {
+            auto const t{ a };
+            a = b;
+            b = t;
+        }
+        if constexpr (tbx::is_integral_v<T>)
+        {
+            auto const base{ static_cast<std::uint64_t>(a) };
+            auto const range{ static_cast<std::uint64_t>(b) - base };
+            return static_cast<T>(base + (range == ~std::uint64_t{}
+                ? tbx::detail::word64(g)
+                : tbx::detail::bounded64(g, range + 1u)));
+        }
+        else
+        {
+            if (!(a < b))
+                throw std::invalid_argument(
+                    "tbx::constexpr_rand(g, a, b): "
+                    "floating-point arguments require a != b");
+            int constexpr digits{ std::numeric_limits<T>::digits < 64 ? std::numeric_limits<T>::digits : 64 };
+            T scale{ 1 };  // 2^-digits, without std::ldexp, which is not constexpr
+            for (int i{ digits }; i--;)
+                scale /= 2;
+            for (;;)
+            {
+                // Rounding can carry the result up to b. When it does, try again.
+                auto const x{ a + static_cast<T>(tbx::detail::word64(g) >> (64 - digits)) * scale * (b - a) };
+                if (x < b)
+                    return x;
+            }
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename T, std::size_t N>
+    constexpr std::array<T, N> constexpr_rand_array(std::uint64_t const seed, T const a, T const b)
+    {
+        std::array<T, N> result{};
+        tbx::splitmix64 g{ seed };
+        for (auto& x : result)
+            x = tbx::constexpr_rand(g, a, b);
+        return result;
+    }
+    //------------------------------------------------------------------
+    template <typename T, std::size_t N>
+    constexpr std::array<T, N> constexpr_rand_array(std::uint64_t const seed)
+    {
+        return tbx::constexpr_rand_array<T, N>(seed, T{}, std::is_floating_point_v<T>
+            ? T{ 1 }
+            : std::numeric_limits<T>::max());
+    }
+
+    //==================================================================
+    // detail - binomial variates
+    //==================================================================
+    namespace detail
+    {
+        // log(k!) - log(sqrt(2 pi) (k + 1)^(k + 1/2) e^-(k + 1)), the
+        // tail of Stirling's series, as used by BTRD
+        inline double stirling_tail(std::uint64_t const k) noexcept
+        {
+            static double constexpr table[]
+            {
+                0.08106146679532726, 0.04134069595540929, 0.02767792568499834,
+                0.02079067210376509, 0.01664469118982119, 0.01387612882307075,
+                0.01189670994589177, 0.01041126526197209, 0.009255462182712733,
+                0.008330563433362871
+            };
+            if (k < 10u)
+                return table[k];
+            auto const r{ 1.0 / (static_cast<double>(k) + 1.0) };
+            auto const rr{ r * r };
+            return (1.0 / 12.0 - (1.0 / 360.0 - (1.0 / 1260.0) * rr) * rr) * r;
+        }
+        //--------------------------------------------------------------
+        // Binomial variates, with the setup done once, for n trials with
+        // success probability p. When the mode is small, the sampler
+        // inverts the cumulative distribution, by sequential search from
+        // zero. Otherwise, it uses Hormann's BTRD (transformed rejection
+        // with decomposition), which takes constant expected time:
+        //
+        // Hormann, W. (1993), "The generation of binomial random variates,"
+        // Journal of Statistical Computation and Simulation 46, 101-110.
+        //
+        // Both methods work with min(p, 1 - p), and reflect the result
+        // when p > 0.5.
+        class binomial_sampler
+        {
+            std::uint64_t n_{};
+            double p_{};           // min(p, 1 - p)
+            bool reflect_{};       // p > 0.5
+            std::uint64_t m_{};    // mode
+            double r_{}, nr_{}, npq_{}, q_n_{};
+            double a_{}, b_{}, c_{}, alpha_{}, v_r_{}, u_rv_r_{};
+        public:
+            binomial_sampler() noexcept
+                = default;
+            binomial_sampler(std::uint64_t const n, double const p)
+                : n_{ n }
+                , p_{ p < 0.5 ? p : 1.0 - p }
+                , reflect_{ 0.5 < p }
+            {
+                if (!(0.0 <= p && p <= 1.0))
+                    throw std::invalid_argument(
+                        "tbx::detail::binomial_sampler::binomial_sampler(n, p): "
+                        "requires 0 <= p <= 1");
+                m_ = static_cast<std::uint64_t>((static_cast<double>(n_) + 1.0) * p_);
+                if (m_ < 11u)
+                {
+                    // exp(n log(1 - p)), without the rounding of 1 - p
+                    q_n_ = std::exp(static_cast<double>(n_) * std::log1p(-p_));
+                    r_ = p_ / (1.0 - p_);
+                    nr_ = (static_cast<double>(n_) + 1.0) * r_;
+                }
+                else
+                {
+                    r_ = p_ / (1.0 - p_);
+                    nr_ = (static_cast<double>(n_) + 1.0) * r_;
+                    npq_ = static_cast<double>(n_) * p_ * (1.0 - p_);
+                    auto const sqrt_npq{ std::sqrt(npq_) };
+                    b_ = 1.15 + 2.53 * sqrt_npq;
+                    a_ = -0.0873 + 0.0248 * b_ + 0.01 * p_;
+                    c_ = static_cast<double>(n_) * p_ + 0.5;
+                    alpha_ = (2.83 + 5.1 / b_) * sqrt_npq;
+                    v_r_ = 0.92 - 4.2 / b_;
+                    u_rv_r_ = 0.86 * v_r_;
+                }
+            }
+            std::uint64_t n() const noexcept  { return n_; }
+            double p() const noexcept         { return reflect_ ? 1.0 - p_ : p_; }
+            template <typename URBG>
+            std::uint64_t operator()(URBG& g) const
+            {
+                if (p_ == 0.0)
+                    return reflect_ ? n_ : 0u;
+                auto const k{ m_ < 11u ? invert(g) : btrd(g) };
+                return reflect_ ? n_ - k : k;
+            }
+        private:
+            template <typename URBG>
+            std::uint64_t invert(URBG& g) const
+            {
+                auto r{ q_n_ };
+                auto u{ tbx::detail::uniform_open01(g) };
+                std::uint64_t k{};
+                while (u > r && k < n_)
+                {
+                    u -= r;
+                    ++k;
+                    auto const r1{ (nr_ / static_cast<double>(k) - r_) * r };
+                    // Far in the tail, the probabilities fall off exponentially,
+                    // and round-off would dominate them. Stop there.
+                    if (r1 < std::numeric_limits<double>::epsilon() && r1 < r)
+                        break;
+                    r = r1;
+                }
+                return k;
+            }
+            template <typename URBG>
+            std::uint64_t btrd(URBG& g) const
+            {
+                auto const n_real{ static_cast<double>(n_) };
+                auto const m_real{ static_cast<double>(m_) };
+                for (;;)
+                {
+                    // Step 1: the triangular "squeeze," accepted at once
+                    auto v{ tbx::detail::uniform_open01(g) };
+                    double u;
+                    if (v <= u_rv_r_)
+                    {
+                        u = v / v_r_ - 0.43;
+                        return static_cast<std::uint64_t>((2.0 * a_ / (0.5 - std::abs(u)) + b_) * u + c_);
+                    }
+                    // Step 2: generate u and v
+                    if (v >= v_r_)
+                    {
+                        u = tbx::detail::uniform_open01(g) - 0.5;
+                    }
+                    else
+                    {
+                        u = v / v_r_ - 0.93;
+                        u = (u < 0.0 ? -0.5 : 0.5) - u;
+                        v = tbx::detail::uniform_open01(g) * v_r_;
+                    }
+                    // Step 3.0: the candidate k
+                    auto const us{ 0.5 - std::abs(u) };
+                    auto const k_real{ std::floor((2.0 * a_ / us + b_) * u + c_) };
+                    if (k_real < 0.0 || n_real < k_real)
+                        continue;
+                    auto const k{ static_cast<std::uint64_t>(k_real) };
+                    v = v * alpha_ / (a_ / (us * us) + b_);
+                    auto const km{ std::abs(k_real - m_real) };
+                    if (km <= 15.0)
+                    {
+                        // Step 3.1: recursive evaluation of f(k)
+                        auto f{ 1.0 };
+                        if (m_ < k)
+                        {
+                            for (auto i{ m_ }; i != k;)
+                                f *= nr_ / static_cast<double>(++i) - r_;
+                        }
+                        else if (k < m_)
+                        {
+                            for (auto i{ k }; i != m_;)
+                                v *= nr_ / static_cast<double>(++i) - r_;
+                        }
+                        if (v <= f)
+                            return k;
+                        continue;
+                    }
+                    // Step 3.2: squeeze acceptance or rejection
+                    v = std::log(v);
+                    auto const rho{ (km / npq_) * (((km / 3.0 + 0.625) * km + 1.0 / 6.0) / npq_ + 0.5) };
+                    auto const t{ -km * km / (2.0 * npq_) };
+                    if (v < t - rho)
+                        return k;
+                    if (t + rho < v)
+                        continue;
+                    // Step 3.3: final acceptance or rejection
+                    auto const nm{ n_real - m_real + 1.0 };
+                    auto const h{ (m_real + 0.5) * std::log((m_real + 1.0) / (r_ * nm))
+                        + stirling_tail(m_) + stirling_tail(n_ - m_) };
+                    auto const nk{ n_real - k_real + 1.0 };
+                    if (v <= h + (n_real + 1.0) * std::log(nm / nk)
+                        + (k_real + 0.5) * std::log(nk * r_ / (k_real + 1.0))
+                        - stirling_tail(k) - stirling_tail(n_ - k))
+                        return k;
+                }
+            }
+        };
+    }
+
+    //==================================================================
+    // rand_counts
+    //==================================================================
+    // tbx::rand_counts(n, a, b) returns the outcome counts, or histogram,
+    // of n calls to tbx::rand<ResultType>(a, b), without making those
+    // calls. Element i of the result is the number of times that a + i
+    // was drawn. tbx::rand_counts(n, first, last) does the same for n
+    // draws of the indices of a range of weights, where index i is
+    // drawn with probability weight[i] / sum(weights).
+    //
+    // The counts are multinomial. They are generated as a series of
+    // conditional binomials: the count for outcome i is binomial, with
+    // the trials that remain after outcomes 0 through i - 1, and the
+    // share of the probability that remains. Each binomial takes
+    // constant expected time, so the cost is O(k) in the number of
+    // outcomes, rather than O(n) in the number of draws.
+    //
+    // The uniform overload draws from the engine of rand<ResultType>(),
+    // and the weighted overload, from the engine of rand<std::size_t>().
+    template <typename ResultType, std::enable_if_t<tbx::is_integral_v<ResultType>, int> = 0>
+    inline std::vector<std::uint64_t> rand_counts(std::uint64_t n, ResultType a, ResultType b)
+    {
+        if (b < a)
+        {
+            auto const t{ a };
+            a = b;
+            b = t;
+        }
+        auto const range{ static_cast<std::uint64_t>(b) - static_cast<std::uint64_t>(a) };
+        if (std::vector<std::uint64_t>{}.max_size() <= range)
+            throw std::invalid_argument(
+                "tbx::rand_counts(n, a, b): "
+                "too many outcomes for a std::vector");
+        auto& g{ tbx::rr<ResultType>().urbg() };
+        std::vector<std::uint64_t> counts(range + 1u);
+        for (std::uint64_t i{}; i < range && n; ++i)
+        {
+            // With k outcomes left, each has probability 1 / k.
+            auto const k{ static_cast<double>(range - i + 1u) };
+            counts[i] = tbx::detail::binomial_sampler{ n, 1.0 / k }(g);
+            n -= counts[i];
+        }
+        counts[range] = n;
+        return counts;
+    }
+    //------------------------------------------------------------------
+    template <typename InputIt, std::enable_if_t<!std::is_arithmetic<InputIt>::value, int> = 0>
+    inline std::vector<std::uint64_t> rand_counts(std::uint64_t n, InputIt first, InputIt last)
+    {
+        // suffix[i] is the total weight of outcomes i and higher. It is
+        // summed from the back, so that the last conditional probability
+        // is exactly 1.
+        std::vector<double> suffix(first, last);
+        if (suffix.empty())
+            throw std::invalid_argument(
+                "tbx::rand_counts(n, first, last): "
+                "requires at least one weight");
+        for (auto i{ suffix.size() }; i--;)
+        {
+            if (!(0.0 <= suffix[i]))
+                throw std::invalid_argument(
+                    "tbx::rand_counts(n, first, last): "
+                    "weights must be non-negative");
+            if (i + 1u < suffix.size())
+                suffix[i] += suffix[i + 1u];
+        }
+        if (!(0.0 < suffix[0]) || suffix[0] == std::numeric_limits<double>::infinity())
+            throw std::invalid_argument(
+                "tbx::rand_counts(n, first, last): "
+                "sum of weights must be positive and finite");
+        auto& g{ tbx::rr<std::size_t>().urbg() };
+        std::vector<std::uint64_t> counts(suffix.size());
+        for (std::size_t i{}; i < counts.size() && n; ++i)
+        {
+            auto const tail{ i + 1u < suffix.size() ? suffix[i + 1u] : 0.0 };
+            auto const p{ suffix[i] > 0.0 ? (suffix[i] - tail) / suffix[i] : 0.0 };
+            counts[i] = p < 1.0 ? tbx::detail::binomial_sampler{ n, p }(g) : n;
+            n -= counts[i];
+        }
+        return counts;
+    }
+    //------------------------------------------------------------------
+    template <typename T>
+    inline std::vector<std::uint64_t> rand_counts(std::uint64_t const n, std::initializer_list<T> const weights)
+    {
+        return tbx::rand_counts(n, weights.begin(), weights.end());
+    }
+
+    //==================================================================
+    // poisson_param, binomial_param, gamma_param
+    //==================================================================
+    // Parameter objects for tbx::rand_poisson, tbx::rand_binomial, and
+    // tbx::rand_gamma. Like tbx::param_type, they hold the parameters
+    // of a distribution; unlike the param_type of the Standard Library
+    // distributions, they also hold the constants that the sampling
+    // algorithm derives from them. Construct one once, and reuse it,
+    // when the same parameters are used many times. When parameters
+    // change on every call, pass them directly to the rand_ functions;
+    // the setup is a handful of arithmetic operations, and nothing is
+    // cached anywhere else.
+    //
+    // Each parameter object can also be called with any uniform random
+    // bit generator, for instance, param(g).
+    namespace detail
+    {
+        // log(k!), by way of Stirling's series. Unlike std::lgamma, it
+        // does not write to the global variable signgam.
+        inline double log_factorial(std::uint64_t const k) noexcept
+        {
+            double constexpr half_log_2pi{ 0.9189385332046728 };
+            auto const k1{ static_cast<double>(k) + 1.0 };
+            return (k1 - 0.5) * std::log(k1) - k1 + half_log_2pi + tbx::detail::stirling_tail(k);
+        }
+        //--------------------------------------------------------------
+        // A standard normal variate, by Marsaglia's polar method. The
+        // second variate of each pair is discarded, so that nothing is
+        // stored between calls.
+        template <typename URBG>
+        inline double standard_normal(URBG& g)
+        {
+            for (;;)
+            {
+                auto const u{ 2.0 * tbx::detail::uniform_open01(g) - 1.0 };
+                auto const v{ 2.0 * tbx::detail::uniform_open01(g) - 1.0 };
+                auto const s{ u * u + v * v };
+                if (s < 1.0 && s > 0.0)
+                    return u * std::sqrt(-2.0 * std::log(s) / s);
+            }
+        }
+    }
+    //------------------------------------------------------------------
+    // Poisson variates. For means below 10, the sampler multiplies
+    // uniform variates until their product drops below exp(-mean). For
+    // larger means, it uses Hormann's PTRS (transformed rejection with
+    // squeeze), which takes constant expected time:
+    //
+    // Hormann, W. (1993), "The transformed rejection method for
+    // generating Poisson random variables," Insurance: Mathematics and
+    // Economics 12, 39-45.
+    class poisson_param
+    {
+        double mean_{ 1.0 };
+        double exp_minus_mean_{};
+        double log_mean_{}, a_{}, b_{}, log_inv_alpha_{}, v_r_{};
+    public:
+        explicit poisson_param(double const mean = 1.0)
+            : mean_{ mean }
+        {
+            if (!(0.0 <= mean && mean < std::numeric_limits<double>::infinity()))
+                throw std::invalid_argument(
+                    "tbx::poisson_param::poisson_param(mean): "
+                    "requires 0 <= mean < infinity");
+            if (mean_ < 10.0)
+            {
+                exp_minus_mean_ = std::exp(-mean_);
+            }
+            else
+            {
+                log_mean_ = std::log(mean_);
+                b_ = 0.931 + 2.53 * std::sqrt(mean_);
+                a_ = -0.059 + 0.02483 * b_;
+                log_inv_alpha_ = std::log(1.1239 + 1.1328 / (b_ - 3.4));
+                v_r_ = 0.9277 - 3.6224 / (b_ - 2.0);
+            }
+        }
+        double mean() const noexcept { return mean_; }
+        template <typename URBG>
+        std::uint64_t operator()(URBG& g) const
+        {
+            return mean_ < 10.0 ? multiply(g) : ptrs(g);
+        }
+        friend bool operator==(poisson_param const& a, poisson_param const& b) noexcept { return a.mean_ == b.mean_; }
+        friend bool operator!=(poisson_param const& a, poisson_param const& b) noexcept { return !(a == b); }
+    private:
+        template <typename URBG>
+        std::uint64_t multiply(URBG& g) const
+        {
+            std::uint64_t k{};
+            for (auto product{ tbx::detail::uniform_open01(g) }; product > exp_minus_mean_; ++k)
+                product *= tbx::detail::uniform_open01(g);
+            return k;
+        }
+        template <typename URBG>
+        std::uint64_t ptrs(URBG& g) const
+        {
+            for (;;)
+            {
+                auto const u{ tbx::detail::uniform_open01(g) - 0.5 };
+                auto const v{ tbx::detail::uniform_open01(g) };
+                auto const us{ 0.5 - std::abs(u) };
+                auto const k_real{ std::floor((2.0 * a_ / us + b_) * u + mean_ + 0.43) };
+                if (us >= 0.07 && v <= v_r_)
+                    return static_cast<std::uint64_t>(k_real);
+                if (k_real < 0.0 || (us < 0.013 && v > us))
+                    continue;
+                auto const k{ static_cast<std::uint64_t>(k_real) };
+                if (std::log(v) + log_inv_alpha_ - std::log(a_ / (us * us) + b_)
+                    <= -mean_ + k_real * log_mean_ - tbx::detail::log_factorial(k))
+                    return k;
+            }
+        }
+    };
+    //------------------------------------------------------------------
+    // Binomial variates, for n trials with success probability p. See
+    // tbx::detail::binomial_sampler, which uses Hormann's BTRD.
+    class binomial_param
+    {
+        tbx::detail::binomial_sampler sampler_{ 1u, 0.5 };
+    public:
+        explicit binomial_param(std::uint64_t const n = 1u, double const p = 0.5)
+            : sampler_{ n, p }
+        {}
+        std::uint64_t n() const noexcept  { return sampler_.n(); }
+        double p() const noexcept         { return sampler_.p(); }
+        template <typename URBG>
+        std::uint64_t operator()(URBG& g) const
+        {
+            return sampler_(g);
+        }
+        friend bool operator==(binomial_param const& a, binomial_param const& b) noexcept { return a.n() == b.n() && a.p() == b.p(); }
+        friend bool operator!=(binomial_param const& a, binomial_param const& b) noexcept { return !(a == b); }
+    };
+    //------------------------------------------------------------------
+    // Gamma variates, with shape alpha and scale beta, by the method of
+    // Marsaglia and Tsang. When alpha < 1, a variate with shape alpha + 1
+    // is multiplied by U^(1 / alpha):
+    //
+    // Marsaglia, G., and W. W. Tsang (2000), "A simple method for
+    // generating gamma variables," ACM Transactions on Mathematical
+    // Software 26, 363-372.
+    class gamma_param
+    {
+        double alpha_{ 1.0 };
+        double beta_{ 1.0 };
+        double d_{}, c_{}, inv_alpha_{};
+    public:
+        explicit gamma_param(double const alpha = 1.0, double const beta = 1.0)
+            : alpha_{ alpha }
+            , beta_{ beta }
+        {
+            if (!(0.0 < alpha && alpha < std::numeric_limits<double>::infinity())
+                || !(0.0 < beta && beta < std::numeric_limits<double>::infinity()))
+                throw std::invalid_argument(
+                    "tbx::gamma_param::gamma_param(alpha, beta): "
+                    "requires alpha > 0 and beta > 0");
+            d_ = (alpha_ < 1.0 ? alpha_ + 1.0 : alpha_) - 1.0 / 3.0;
+            c_ = 1.0 / std::sqrt(9.0 * d_);
+            inv_alpha_ = 1.0 / alpha_;
+        }
+        double alpha() const noexcept  { return alpha_; }
+        double beta() const noexcept   { return beta_; }
+        template <typename URBG>
+        double operator()(URBG& g) const
+        {
+            auto x{ marsaglia_tsang(g) };
+            if (alpha_ < 1.0)
+                x *= std::pow(tbx::detail::uniform_open01(g), inv_alpha_);
+            return x * beta_;
+        }
+        friend bool operator==(gamma_param const& a, gamma_param const& b) noexcept { return a.alpha_ == b.alpha_ && a.beta_ == b.beta_; }
+        friend bool operator!=(gamma_param const& a, gamma_param const& b) noexcept { return !(a == b); }
+    private:
+        template <typename URBG>
+        double marsaglia_tsang(URBG& g) const
+        {
+            for (;;)
+            {
+                double x, v;
+                do
+                {
+                    x = tbx::detail::standard_normal(g);
+                    v = 1.0 + c_ * x;
+                } while (v <= 0.0);
+                v = v * v * v;
+                auto const u{ tbx::detail::uniform_open01(g) };
+                auto const x2{ x * x };
+                if (u < 1.0 - 0.0331 * x2 * x2)
+                    return d_ * v;
+                if (std::log(u) < 0.5 * x2 + d_ * (1.0 - v + std::log(v)))
+                    return d_ * v;
+            }
+        }
+    };
+
+    //==================================================================
+    // rand_poisson, rand_binomial, rand_gamma
+    //==================================================================
+    // Like tbx::rand<ResultType>(), each function draws from the
+    // thread_local engine for its ResultType, so it is seeded with
+    // tbx::srand<ResultType>().
+    //
+    //    rand_poisson<IntType>(mean)          IntType defaults to int
+    //    rand_binomial<IntType>(n, p)         IntType defaults to int
+    //    rand_gamma<RealType>(alpha, beta)    RealType defaults to double
+    //
+    // Each function has a second overload that takes the corresponding
+    // parameter object, which skips the setup.
+    template <typename IntType = int>
+    inline IntType rand_poisson(tbx::poisson_param const& p)
+    {
+        static_assert(tbx::is_integral_v<IntType>, "");
+        return static_cast<IntType>(p(tbx::rr<IntType>().urbg()));
+    }
+    template <typename IntType = int>
+    inline IntType rand_poisson(double const mean)
+    {
+        return tbx::rand_poisson<IntType>(tbx::poisson_param{ mean });
+    }
+    //------------------------------------------------------------------
+    template <typename IntType = int>
+    inline IntType rand_binomial(tbx::binomial_param const& p)
+    {
+        static_assert(tbx::is_integral_v<IntType>, "");
+        return static_cast<IntType>(p(tbx::rr<IntType>().urbg()));
+    }
+    template <typename IntType = int>
+    inline IntType rand_binomial(std::uint64_t const n, double const p)
+    {
+        return tbx::rand_binomial<IntType>(tbx::binomial_param{ n, p });
+    }
+    //------------------------------------------------------------------
+    template <typename RealType = double>
+    inline RealType rand_gamma(tbx::gamma_param const& p)
+    {
+        static_assert(std::is_floating_point_v<RealType>, "");
+        return static_cast<RealType>(p(tbx::rr<RealType>().urbg()));
+    }
+    template <typename RealType = double>
+    inline RealType rand_gamma(double const alpha, double const beta = 1.0)
+    {
+        return tbx::rand_gamma<RealType>(tbx::gamma_param{ alpha, beta });
+    }
+
+    //==================================================================
+    // monte_carlo_reduce
+    //==================================================================
+    // tbx::monte_carlo_reduce(n, kernel, reduce) runs n trials of a
+    // Monte Carlo simulation on a pool of std::threads, and combines
+    // their results:
+    //
+    //   auto const hits{ tbx::monte_carlo_reduce(n, [](auto& g) {
+    //       auto const x{ tbx::rand<double>() }, y{ tbx::rand<double>() };
+    //       return x * x + y * y < 1.0 ? 1 : 0;
+    //   }, std::plus<>{}) };
+    //
+    // Each trial calls kernel(g), where g is the worker's engine (the
+    // engine of its thread_local tbx::rr<double>()), and the results are
+    // folded together with reduce(a, b). Within a worker, the kernel
+    // may draw either from g, or from tbx::rand<double>(); they are the
+    // same engine. The kernel and reduce functions are shared among
+    // the workers, and must be safe to call concurrently.
+    //
+    // The trials are divided into chunks, whose size depends only on n.
+    // Before a chunk is run, the engine is seeded from a fixed_seed_seq
+    // made from (seed, chunk index), so that each chunk has its own
+    // reproducible stream. The partial result of each chunk is stored
+    // in a slot of its own, padded to a cache line, and the partial
+    // results are combined in chunk order after the workers finish.
+    // Thus, for a given seed, the result does not depend on the number
+    // of threads, or on how the chunks were scheduled.
+    //
+    // Chunks are dealt out to the workers in contiguous runs. A worker
+    // that runs out steals chunks from the back of another's run. If a
+    // kernel throws, the remaining chunks are abandoned, and the first
+    // exception is rethrown to the caller. Likewise, if a worker
+    // thread cannot be started, the workers already running are
+    // stopped and joined, and the std::system_error is rethrown. When
+    // n == 0, the result is a value-initialized T.
+    namespace detail
+    {
+        // A run of chunks, [next, end), packed into one atomic word, so
+        // that the owner (from the front) and thieves (from the back)
+        // can both claim chunks with a single compare-and-swap.
+        struct alignas(64) chunk_run
+        {
+            std::atomic<std::uint64_t> bounds{};
+            bool pop_front(std::uint32_t& chunk) noexcept
+            {
+                auto b{ bounds.load(std::memory_order_relaxed) };
+                for (;;)
+                {
+                    auto const next{ static_cast<std::uint32_t>(b >> 32) };
+                    auto const end{ static_cast<std::uint32_t>(b) };
+                    if (!(next < end))
+                        return false;
+                    if (bounds.compare_exchange_weak(b, std::uint64_t{ next + 1u } << 32 | end, std::memory_order_relaxed))
+                    {
+                        chunk = next;
+                        return true;
+                    }
+                }
+            }
+            bool pop_back(std::uint32_t& chunk) noexcept
+            {
+                auto b{ bounds.load(std::memory_order_relaxed) };
+                for (;;)
+                {
+                    auto const next{ static_cast<std::uint32_t>(b >> 32) };
+                    auto const end{ static_cast<std::uint32_t>(b) };
+                    if (!(next < end))
+                        return false;
+                    if (bounds.compare_exchange_weak(b, std::uint64_t{ next } << 32 | (end - 1u), std::memory_order_relaxed))
+                    {
+                        chunk = end - 1u;
+                        return true;
+                    }
+                }
+            }
+        };
+        //--------------------------------------------------------------
+        template <typename T>
+        struct alignas(64) padded_result
+        {
+            T value{};
+        };
+    }
+    //------------------------------------------------------------------
+    template <typename Kernel, typename Reduce>
+    inline auto monte_carlo_reduce
+    (
+        std::uint64_t const n
+        , Kernel kernel
+        , Reduce reduce
+        , std::uint64_t const seed = 1u
+        , unsigned n_threads = 0u   // 0u means std::thread::hardware_concurrency()
+    )
+    {
+        using urbg_type = typename tbx::rand_replacement<double>::urbg_type;
+        using result_type = std::decay_t<std::invoke_result_t<Kernel&, urbg_type&>>;
+        enum : std::uint64_t { min_chunk_size = 1'024u, max_chunks = 65'536u };
+        if (n == 0u)
+            return result_type{};
+        auto const chunk_size{ std::max<std::uint64_t>(min_chunk_size, (n - 1u) / max_chunks + 1u) };
+        auto const n_chunks{ static_cast<std::uint32_t>((n - 1u) / chunk_size + 1u) };
+        if (n_threads == 0u)
+            n_threads = std::max(1u, std::thread::hardware_concurrency());
+        n_threads = std::min(n_threads, n_chunks);
+
+        std::vector<tbx::detail::padded_result<result_type>> partials(n_chunks);
+        std::vector<tbx::detail::chunk_run> runs(n_threads);
+        for (unsigned t{}; t < n_threads; ++t)
+        {
+            auto const first{ static_cast<std::uint64_t>(n_chunks) * t / n_threads };
+            auto const last{ static_cast<std::uint64_t>(n_chunks) * (t + 1u) / n_threads };
+            runs[t].bounds.store(first << 32 | last, std::memory_order_relaxed);
+        }
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto const work = [&](unsigned const self)
+        {
+            auto& g{ tbx::rr<double>().urbg() };
+            std::uint32_t chunk{};
+            auto claim = [&]
+            {
+                if (runs[self].pop_front(chunk))
+                    return true;
+                for (unsigned i{ 1u }; i < n_threads; ++i)
+                    if (runs[(self + i) % n_threads].pop_back(chunk))
+                        return true;
+                return false;
+            };
+            try
+            {
+                while (!failed.load(std::memory_order_relaxed) && claim())
+                {
+                    tbx::fixed_seed_seq<4u> sseq
+                    {
+                        static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32), chunk
+                    };
+                    g.seed(sseq);
+                    auto const first{ chunk * chunk_size };
+                    auto const count{ std::min(chunk_size, n - first) };
+                    auto acc{ kernel(g) };
+                    for (auto i{ count - 1u }; i--;)
+                        acc = reduce(std::move(acc), kernel(g));
+                    partials[chunk].value = std::move(acc);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{ error_mutex };
+                if (!failed.exchange(true))
+                    error = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(n_threads);
+        try
+        {
+            for (unsigned t{}; t < n_threads; ++t)
+                pool.emplace_back(work, t);
+        }
+        catch (...)
+        {
+            // Destroying a joinable std::thread would call std::terminate.
+            failed.store(true);
+            for (auto& worker : pool)
+                worker.join();
+            throw;
+        }
+        for (auto& worker : pool)
+            worker.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        auto result{ std::move(partials[0].value) };
+        for (std::uint32_t i{ 1u }; i < n_chunks; ++i)
+            result = reduce(std::move(result), std::move(partials[i].value));
+        return result;
+    }
+
+    //==================================================================
+    // task_rng
+    //==================================================================
+    // On a work-stealing thread pool, the thread that runs a given task
+    // is a matter of chance, and so is the state of its thread_local
+    // engine. A tbx::task_rng<ResultType> is keyed to the task instead:
+    //
+    //   tbx::task_rng<double> rng(root_seed, task_id);
+    //   auto const x{ rng.rand() };        // [0.0, 1.0)
+    //   auto const y{ rng.rand(-1.0, 1.0) };
+    //
+    // Its engine is a tbx::splitmix64, whose starting state is a hash
+    // of (root_seed, task_id). It occupies eight bytes, and costs two
+    // multiplications to construct, so one can be made for every task.
+    // Distinct tasks start at unrelated points of the 2^64 cycle, so
+    // their streams do not overlap in practice.
+    //
+    // The member functions mirror those of rand_replacement: rand(),
+    // rand(a, b), rand(param), and rand_max(). Values are computed by
+    // tbx::constexpr_rand, rather than by the distributions of the
+    // Standard Library, so they are the same on every platform.
+    template <typename ResultType = int>
+    class task_rng
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+    public:
+        using urbg_type = tbx::splitmix64;
+        using seed_type = std::uint64_t;
+        using param_type = tbx::param_type<ResultType>;
+        using result_type = ResultType;
+    private:
+        urbg_type eng_;
+        auto static constexpr default_b() noexcept
+        {
+            return std::is_floating_point_v<result_type> ? result_type{ 1 } : std::numeric_limits<result_type>::max();
+        }
+        template <typename T>
+        auto static check(T const x)
+        {
+            if (x < static_cast<T>(std::numeric_limits<result_type>::lowest())
+                || static_cast<T>(std::numeric_limits<result_type>::max()) < x)
+                throw std::invalid_argument(
+                    "tbx::task_rng<ResultType>::rand(param): "
+                    "param out of range for ResultType");
+            return static_cast<result_type>(x);
+        }
+    public:
+        constexpr task_rng(seed_type const root_seed, std::uint64_t const task_id) noexcept
+            : eng_{ urbg_type::mix(urbg_type::mix(root_seed) ^ task_id) }
+        {}
+        auto rand()                             { return tbx::constexpr_rand(eng_, result_type{}, default_b()); }
+        auto rand_max() const noexcept          { return default_b(); }
+        auto rand(param_type const& p)          { return tbx::constexpr_rand(eng_, check(p.a()), check(p.b())); }
+        auto& urbg() noexcept                   { return eng_; }
+        auto rand(result_type const a, result_type const b) {
+            return tbx::constexpr_rand(eng_, a, b);
+        }
+    };
+
+    //==================================================================
+    // rand_bounded_batch
+    //==================================================================
+    // tbx::rand_bounded_batch(bounds_in, out, count) reads count bounds,
+    // and writes count random values, one per bound. When the bound is
+    // b, the value is uniform on [0, b). That is the same as calling
+    // tbx::rand(0, b - 1) for an integer bound, or tbx::rand(0.0, b)
+    // for a floating-point bound, once per element, but without
+    // constructing a param_type each time.
+    //
+    //   std::vector<int> bucket_size{ ... }, pick(bucket_size.size());
+    //   tbx::rand_bounded_batch(bucket_size.begin(), pick.begin(), pick.size());
+    //
+    // The work is done in blocks of 256 elements. For integers, the
+    // engine words of a block are drawn first; next, they are reduced
+    // to their bounds with Lemire's multiply-high method, in a bulk
+    // kernel (see bulk_isa); finally, a scalar pass redraws the rare
+    // words that must be rejected to avoid bias.
+    // Blocks whose bounds do not all fit in 32 bits are handled one
+    // element at a time.
+    //
+    // Every bound must be positive (and finite). Otherwise, an
+    // invalid_argument exception is thrown, before any values are
+    // drawn for the block that holds the bad bound. Earlier blocks
+    // will already have been written.
+    //
+    // Values are drawn from the engine of thread_local
+    // tbx::rr<T>(), where T is the value type of the bounds. They
+    // are not the values that rand() would have produced.
+    namespace detail
+    {
+        // Multiply words[i] by s[i]. The high 32 bits of the product
+        // are stored in hi[i], and the low 32 bits replace words[i].
+        // Return true if any low word is less than its bound, i.e., if
+        // a rejection might be required.
+        struct bounded_multiply_kernel
+        {
+            bool static constexpr const floating_point{ false };
+            TBX_RAND_KERNEL_BODY
+            static bool body(std::uint32_t* const words, std::uint32_t const* const s, std::uint32_t* const hi
+                , std::size_t const n) noexcept
+            {
+                std::uint32_t maybe_reject{};
+                for (std::size_t i{}; i < n; ++i)
+                {
+                    auto const m{ std::uint64_t{ words[i] } * s[i] };
+                    words[i] = static_cast<std::uint32_t>(m);
+                    hi[i] = static_cast<std::uint32_t>(m >> 32);
+                    maybe_reject |= words[i] < s[i];
+                }
+                return maybe_reject != 0u;
+            }
+        };
+        //--------------------------------------------------------------
+        // Integral bounds
+        template <typename T, typename URBG>
+        inline void bounded_block(URBG& g, T const* const bound, T* const out, std::size_t const n, std::true_type)
+        {
+            auto narrow{ true };
+            for (std::size_t i{}; i < n; ++i)
+                narrow &= static_cast<std::uint64_t>(bound[i]) <= 0xffff'ffffu;
+            if (!narrow)
+            {
+                for (std::size_t i{}; i < n; ++i)
+                    out[i] = static_cast<T>(tbx::detail::bounded(g, static_cast<std::uint64_t>(bound[i])));
+                return;
+            }
+            std::uint32_t words[bulk_block_size], s[bulk_block_size]{}, hi[bulk_block_size];
+            for (std::size_t i{}; i < n; ++i)
+                s[i] = static_cast<std::uint32_t>(bound[i]);
+            tbx::detail::fill_words(g, words, n);
+            if (tbx::detail::dispatch<tbx::detail::bounded_multiply_kernel>(words, static_cast<std::uint32_t const*>(s), hi, n))
+            {
+                for (std::size_t i{}; i < n; ++i)
+                    if (words[i] < s[i] && words[i] < static_cast<std::uint32_t>(0u - s[i]) % s[i])
+                        hi[i] = tbx::detail::bounded32(g, s[i]);
+            }
+            for (std::size_t i{}; i < n; ++i)
+                out[i] = static_cast<T>(hi[i]);
+        }
+        //--------------------------------------------------------------
+        // Floating-point bounds
+        template <typename T, typename URBG>
+        inline void bounded_block(URBG& g, T const* const bound, T* const out, std::size_t const n, std::false_type)
+        {
+            tbx::detail::generate_block(g, out, n, T{ 0 }, T{ 1 }, std::false_type{});
+            for (std::size_t i{}; i < n; ++i)
+            {
+                auto const x{ out[i] * bound[i] };
+                out[i] = x < bound[i] ? x : std::nextafter(bound[i], T{ 0 });
+            }
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename InputIt, typename OutputIt>
+    inline OutputIt rand_bounded_batch(InputIt bounds_in, OutputIt out, std::size_t count)
+    {
+        using value_type = typename std::iterator_traits<InputIt>::value_type;
+        using is_integral = std::integral_constant<bool, tbx::is_integral_v<value_type>>;
+        static_assert(tbx::is_arithmetic_v<value_type>, "");
+        static_assert(!std::is_same_v<value_type, bool>, "");
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        auto& g{ tbx::rr<value_type>().urbg() };
+        value_type bound[block_size], value[block_size];
+        while (count)
+        {
+            auto const n{ count < block_size ? count : std::size_t{ block_size } };
+            auto valid{ true };
+            for (std::size_t i{}; i < n; ++i, ++bounds_in)
+            {
+                bound[i] = *bounds_in;
+                valid = value_type{ 0 } < bound[i] && bound[i] <= std::numeric_limits<value_type>::max() && valid;
+            }
+            if (!valid)
+                throw std::invalid_argument(
+                    "tbx::rand_bounded_batch(bounds_in, out, count): "
+                    "bounds must be positive and finite");
+            tbx::detail::bounded_block(g, bound, value, n, is_integral{});
+            for (std::size_t i{}; i < n; ++i)
+                *out++ = value[i];
+            count -= n;
+        }
+        return out;
+    }
+
+    //==================================================================
+    // qrand - quasi-random (low-discrepancy) sequences
+    //==================================================================
+    // A qrand<RealType, Dim, Sequence> generates the points of a low-
+    // discrepancy sequence in Dim dimensions. Points fill the unit cube
+    // far more evenly than independent uniform draws, so that Monte
+    // Carlo integrals of smooth functions converge at close to O(1/n),
+    // rather than O(1/sqrt(n)).
+    //
+    //    qrand_sequence::sobol    Sobol points, with the direction
+    //                              numbers of Joe and Kuo (2008), for up
+    //                              to 64 dimensions. Each coordinate has
+    //                              32 bits of resolution, and the
+    //                              sequence repeats after 2^32 points.
+    //
+    //    qrand_sequence::halton   Halton points, using the first Dim
+    //                              prime numbers as bases, for up to 64
+    //                              dimensions. Halton points degrade in
+    //                              high dimensions faster than Sobol
+    //                              points do.
+    //
+    // The member functions follow the conventions of tbx::rand(), but
+    // each call returns a std::array of Dim coordinates:
+    //
+    //    rand()          next point, on [0, 1) in each coordinate
+    //    rand(a, b)      next point, on [a, b) in each coordinate
+    //    rand(param)     same, with a and b taken from a param_type
+    //    srand(seed)     randomize the sequence, using a seed
+    //    srand()         randomize it, using std::random_device
+    //    srand(seed_seq) randomize it, using a seed sequence
+    //
+    // A qrand that has not been seeded produces the deterministic
+    // sequence. Seeding it scrambles the points, and restarts the
+    // sequence: Sobol points are Owen-scrambled, using the hash-based
+    // nested uniform scramble of Burley (2020); Halton points get a
+    // random linear scramble of their digits, with different factors
+    // for each digit position. Either way, the points keep their even
+    // spread, and averages over independently seeded sequences give
+    // unbiased estimates, with error bars (randomized QMC).
+    //
+    // seek(i) jumps to point i in O(1) time, so that each thread of a
+    // parallel computation can take its own slice of one sequence.
+    // generate(out, n) writes the next n points. Sobol points are
+    // produced in Gray-code order, where each point differs from the
+    // one before it by a single XOR per coordinate.
+    //
+    // A qrand is a value type, with no thread_local state. Use one per
+    // thread.
+    enum class qrand_sequence { sobol, halton };
+    namespace detail
+    {
+        // Joe and Kuo, "Constructing Sobol sequences with better two-
+        // dimensional projections," file new-joe-kuo-6.21201: the degree
+        // s and coefficients a of a primitive polynomial, and the
+        // initial direction numbers m[0..s), for dimensions 2 to 64.
+        // Dimension 1 uses the identity.
+        struct sobol_polynomial
+        {
+            std::uint8_t s;
+            std::uint8_t a;
+            std::uint16_t m[9];
+        };
+        inline constexpr sobol_polynomial sobol_polynomials[63]
+        {
+            { 1,   0, { 1 } },
+            { 2,   1, { 1, 3 } },
+            { 3,   1, { 1, 3, 1 } },
+            { 3,   2, { 1, 1, 1 } },
+            { 4,   1, { 1, 1, 3, 3 } },
+            { 4,   4, { 1, 3, 5, 13 } },
+            { 5,   2, { 1, 1, 5, 5, 17 } },
+            { 5,   4, { 1, 1, 5, 5, 5 } },
+            { 5,   7, { 1, 1, 7, 11, 19 } },
+            { 5,  11, { 1, 1, 5, 1, 1 } },
+            { 5,  13, { 1, 1, 1, 3, 11 } },
+            { 5,  14, { 1, 3, 5, 5, 31 } },
+            { 6,   1, { 1, 3, 3, 9, 7, 49 } },
+            { 6,  13, { 1, 1, 1, 15, 21, 21 } },
+            { 6,  16, { 1, 3, 1, 13, 27, 49 } },
+            { 6,  19, { 1, 1, 1, 15, 7, 5 } },
+            { 6,  22, { 1, 3, 1, 15, 13, 25 } },
+            { 6,  25, { 1, 1, 5, 5, 19, 61 } },
+            { 7,   1, { 1, 3, 7, 11, 23, 15, 103 } },
+            { 7,   4, { 1, 3, 7, 13, 13, 15, 69 } },
+            { 7,   7, { 1, 1, 3, 13, 7, 35, 63 } },
+            { 7,   8, { 1, 3, 5, 9, 1, 25, 53 } },
+            { 7,  14, { 1, 3, 1, 13, 9, 35, 107 } },
+            { 7,  19, { 1, 3, 1, 5, 27, 61, 31 } },
+            { 7,  21, { 1, 1, 5, 11, 19, 41, 61 } },
+            { 7,  28, { 1, 3, 5, 3, 3, 13, 69 } },
+            { 7,  31, { 1, 1, 7, 13, 1, 19, 1 } },
+            { 7,  32, { 1, 3, 7, 5, 13, 19, 59 } },
+            { 7,  37, { 1, 1, 3, 9, 25, 29, 41 } },
+            { 7,  41, { 1, 3, 5, 13, 23, 1, 55 } },
+            { 7,  42, { 1, 3, 7, 3, 13, 59, 17 } },
+            { 7,  50, { 1, 3, 1, 3, 5, 53, 69 } },
+            { 7,  55, { 1, 1, 5, 5, 23, 33, 13 } },
+            { 7,  56, { 1, 1, 7, 7, 1, 61, 123 } },
+            { 7,  59, { 1, 1, 7, 9, 13, 61, 49 } },
+            { 7,  62, { 1, 3, 3, 5, 3, 55, 33 } },
+            { 8,  14, { 1, 3, 1, 15, 31, 13, 49, 245 } },
+            { 8,  21, { 1, 3, 5, 15, 31, 59, 63, 97 } },
+            { 8,  22, { 1, 3, 1, 11, 11, 11, 77, 249 } },
+            { 8,  38, { 1, 3, 1, 11, 27, 43, 71, 9 } },
+            { 8,  47, { 1, 1, 7, 15, 21, 11, 81, 45 } },
+            { 8,  49, { 1, 3, 7, 3, 25, 31, 65, 79 } },
+            { 8,  50, { 1, 3, 1, 1, 19, 11, 3, 205 } },
+            { 8,  52, { 1, 1, 5, 9, 19, 21, 29, 157 } },
+            { 8,  56, { 1, 3, 7, 11, 1, 33, 89, 185 } },
+            { 8,  67, { 1, 3, 3, 3, 15, 9, 79, 71 } },
+            { 8,  70, { 1, 3, 7, 11, 15, 39, 119, 27 } },
+            { 8,  84, { 1, 1, 3, 1, 11, 31, 97, 225 } },
+            { 8,  97, { 1, 1, 1, 3, 23, 43, 57, 177 } },
+            { 8, 103, { 1, 3, 7, 7, 17, 17, 37, 71 } },
+            { 8, 115, { 1, 3, 1, 5, 27, 63, 123, 213 } },
+            { 8, 122, { 1, 1, 3, 5, 11, 43, 53, 133 } },
+            { 9,   8, { 1, 3, 5, 5, 29, 17, 47, 173, 479 } },
+            { 9,  13, { 1, 3, 3, 11, 3, 1, 109, 9, 69 } },
+            { 9,  16, { 1, 1, 1, 5, 17, 39, 23, 5, 343 } },
+            { 9,  22, { 1, 3, 1, 5, 25, 15, 31, 103, 499 } },
+            { 9,  25, { 1, 1, 1, 11, 11, 17, 63, 105, 183 } },
+            { 9,  44, { 1, 1, 5, 11, 9, 29, 97, 231, 363 } },
+            { 9,  47, { 1, 1, 5, 15, 19, 45, 41, 7, 383 } },
+            { 9,  52, { 1, 3, 7, 7, 31, 19, 83, 137, 221 } },
+            { 9,  55, { 1, 1, 1, 3, 23, 15, 111, 223, 83 } },
+            { 9,  59, { 1, 1, 5, 13, 31, 15, 55, 25, 161 } },
+            { 9,  62, { 1, 1, 3, 13, 25, 47, 39, 87, 257 } },
+        };
+        //--------------------------------------------------------------
+        inline constexpr std::uint16_t halton_bases[64]
+        {
+              2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+             59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131,
+            137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+            227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+        };
+        //--------------------------------------------------------------
+        constexpr std::uint32_t reverse_bits32(std::uint32_t x) noexcept
+        {
+            x = ((x >> 1) & 0x5555'5555u) | ((x & 0x5555'5555u) << 1);
+            x = ((x >> 2) & 0x3333'3333u) | ((x & 0x3333'3333u) << 2);
+            x = ((x >> 4) & 0x0f0f'0f0fu) | ((x & 0x0f0f'0f0fu) << 4);
+            x = ((x >> 8) & 0x00ff'00ffu) | ((x & 0x00ff'00ffu) << 8);
+            return (x >> 16) | (x << 16);
+        }
+        //--------------------------------------------------------------
+        // Burley, "Practical Hash-based Owen Scrambling" (2020). The
+        // Laine-Karras hash lets each bit be flipped by the bits below
+        // it, but not above it. Applied to the reversed bits of a
+        // coordinate, that flips each bit by the bits above it, which
+        // is an Owen (nested uniform) scramble.
+        constexpr std::uint32_t owen_scramble(std::uint32_t x, std::uint32_t const seed) noexcept
+        {
+            x = tbx::detail::reverse_bits32(x);
+            x += seed;
+            x ^= x * 0x6c50'b47cu;
+            x ^= x * 0xb82f'1e52u;
+            x ^= x * 0xc7af'e638u;
+            x ^= x * 0x8d22'f6e6u;
+            return tbx::detail::reverse_bits32(x);
+        }
+        //--------------------------------------------------------------
+        constexpr unsigned count_trailing_zeros32(std::uint32_t x) noexcept
+        {
+            unsigned n{};
+            for (; !(x & 1u); x >>= 1)
+                ++n;
+            return n;
+        }
+    }
+    //------------------------------------------------------------------
+    template
+        < typename RealType = double
+        , std::size_t Dim = 1u
+        , tbx::qrand_sequence Sequence = tbx::qrand_sequence::sobol
+        >
+    class qrand
+    {
+        static_assert(std::is_floating_point_v<RealType>, "");
+        static_assert(0u < Dim && Dim <= 64u, "");
+    public:
+        using result_type = std::array<RealType, Dim>;
+        using param_type = tbx::param_type<RealType>;
+        using seed_type = typename std::mt19937::result_type;
+        auto static constexpr const sequence{ Sequence };
+    private:
+        auto static constexpr const is_sobol{ Sequence == tbx::qrand_sequence::sobol };
+        enum : std::size_t { n_bits = 32u };
+        using directions_type = std::array<std::array<std::uint32_t, n_bits>, is_sobol ? Dim : 0u>;
+        std::uint64_t index_{};
+        bool scrambled_{};
+        std::array<std::uint64_t, Dim> keys_{};  // scrambling keys
+        std::array<std::uint32_t, Dim> x_{};     // Sobol: the current point, before scrambling
+        directions_type v_{};                    // Sobol: direction numbers
+    public:
+        qrand() noexcept
+        {
+            if constexpr (is_sobol)
+                set_directions();
+        }
+        explicit qrand(seed_type const seed) noexcept
+            : qrand()
+        {
+            srand(seed);
+        }
+        //--------------------------------------------------------------
+        static constexpr std::size_t dimension() noexcept { return Dim; }
+        std::uint64_t index() const noexcept              { return index_; }
+        void discard(std::uint64_t const n) noexcept      { seek(index_ + n); }
+        void seek(std::uint64_t const i) noexcept
+        {
+            index_ = i;
+            if constexpr (is_sobol)
+            {
+                // Point i is built from the bits of gray(i).
+                auto const gray{ static_cast<std::uint32_t>(i ^ (i >> 1)) };
+                for (std::size_t d{}; d < Dim; ++d)
+                {
+                    std::uint32_t x{};
+                    for (std::size_t j{}; j < n_bits; ++j)
+                        x ^= ((gray >> j) & 1u) ? v_[d][j] : 0u;
+                    x_[d] = x;
+                }
+            }
+        }
+        //--------------------------------------------------------------
+        void srand(seed_type const seed) noexcept  { set_keys(std::uint64_t{ seed }); }
+        void srand()                               { tbx::seed_seq_rd s; srand(s); }
+        template <typename SeedSeq, typename = std::enable_if_t<!std::is_arithmetic<SeedSeq>::value>>
+        void srand(SeedSeq& sseq)
+        {
+            std::array<std::uint32_t, 2u> w{};
+            sseq.generate(w.begin(), w.end());
+            set_keys(std::uint64_t{ w[0] } << 32 | w[1]);
+        }
+        //--------------------------------------------------------------
+        result_type rand()                         { return next(RealType{ 0 }, RealType{ 1 }); }
+        result_type rand(param_type const& p)      { return rand(p.a(), p.b()); }
+        result_type rand(RealType const a, RealType const b)
+        {
+            if (!(a < b) && !(b < a))
+                throw std::invalid_argument(
+                    "tbx::qrand<RealType, Dim, Sequence>::rand(a, b): "
+                    "requires a != b");
+            return a < b ? next(a, b) : next(b, a);
+        }
+        template <typename OutputIt>
+        OutputIt generate(OutputIt out, std::size_t n)
+        {
+            for (; n; --n)
+                *out++ = next(RealType{ 0 }, RealType{ 1 });
+            return out;
+        }
+    private:
+        void set_directions() noexcept
+        {
+            for (std::size_t j{}; j < n_bits; ++j)
+                v_[0][j] = std::uint32_t{ 1u } << (n_bits - 1u - j);
+            for (std::size_t d{ 1u }; d < Dim; ++d)
+            {
+                auto const& p{ tbx::detail::sobol_polynomials[d - 1u] };
+                auto& v{ v_[d] };
+                std::size_t const s{ p.s };
+                for (std::size_t j{}; j < s; ++j)
+                    v[j] = std::uint32_t{ p.m[j] } << (n_bits - 1u - j);
+                for (auto j{ s }; j < n_bits; ++j)
+                {
+                    v[j] = v[j - s] ^ (v[j - s] >> s);
+                    for (std::size_t k{ 1u }; k < s; ++k)
+                        v[j] ^= ((p.a >> (s - 1u - k)) & 1u) ? v[j - k] : 0u;
+                }
+            }
+        }
+        void set_keys(std::uint64_t const seed) noexcept
+        {
+            tbx::splitmix64 g{ seed };
+            for (auto& key : keys_)
+                key = g();
+            scrambled_ = true;
+            seek(0u);
+        }
+        // Coordinate d of the current point, on [0, 1)
+        RealType unit(std::size_t const d) const noexcept
+        {
+            if constexpr (is_sobol)
+            {
+                auto const x{ scrambled_
+                    ? tbx::detail::owen_scramble(x_[d], static_cast<std::uint32_t>(keys_[d]))
+                    : x_[d] };
+                return static_cast<RealType>(x) * static_cast<RealType>(0x1p-32);
+            }
+            else
+            {
+                // The radical inverse of index_, in base b. When the
+                // sequence is scrambled, digit k (including the zeros
+                // beyond the last nonzero digit) becomes (f * digit + g)
+                // mod b, where f != 0 and g are drawn from a hash of the
+                // key and k.
+                std::uint64_t const b{ tbx::detail::halton_bases[d] };
+                auto const tiny{ std::ldexp(RealType{ 1 }, -std::numeric_limits<RealType>::digits - 1) };
+                auto const base_inverse{ RealType{ 1 } / static_cast<RealType>(b) };
+                auto i{ index_ };
+                RealType u{}, weight{ base_inverse };
+                for (std::uint64_t k{}; (i != 0u || scrambled_) && tiny <= weight; ++k)
+                {
+                    auto digit{ i % b };
+                    i /= b;
+                    if (scrambled_)
+                    {
+                        auto const h{ tbx::splitmix64::mix(keys_[d] + k) };
+                        digit = ((h % (b - 1u) + 1u) * digit + (h >> 32) % b) % b;
+                    }
+                    u += static_cast<RealType>(digit) * weight;
+                    weight *= base_inverse;
+                }
+                return u;
+            }
+        }
+        void advance() noexcept
+        {
+            ++index_;
+            if constexpr (is_sobol)
+            {
+                auto const low{ static_cast<std::uint32_t>(index_) };
+                if (low == 0u)
+                {
+                    x_.fill(0u);  // the sequence repeats after 2^32 points
+                    return;
+                }
+                auto const j{ tbx::detail::count_trailing_zeros32(low) };
+                for (std::size_t d{}; d < Dim; ++d)
+                    x_[d] ^= v_[d][j];
+            }
+        }
+        result_type next(RealType const a, RealType const b)
+        {
+            auto const width{ b - a };
+            auto const below_b{ std::nextafter(b, a) };
+            result_type r;
+            for (std::size_t d{}; d < Dim; ++d)
+            {
+                // Rounding can carry a + u * (b - a) up to b, which
+                // is outside the range.
+                auto const x{ a + unit(d) * width };
+                r[d] = x < b ? x : below_b;
+            }
+            advance();
+            return r;
+        }
+    };
+    //------------------------------------------------------------------
+    template <typename RealType = double, std::size_t Dim = 1u>
+    using sobol = tbx::qrand<RealType, Dim, tbx::qrand_sequence::sobol>;
+    template <typename RealType = double, std::size_t Dim = 1u>
+    using halton = tbx::qrand<RealType, Dim, tbx::qrand_sequence::halton>;
+
+    //==================================================================
+    // Geometric sampling: unit vectors, disks, balls, spheres, rotations
+    //==================================================================
+    // These functions draw points that are uniformly distributed over
+    // simple shapes. None of them uses rejection: each point costs a
+    // fixed number of uniform draws, and no draws are wasted.
+    //
+    //    rand_unit_vector<N>()   a direction in N dimensions, i.e., a
+    //                             point on the unit sphere in R^N
+    //    rand_on_sphere(r)       a point on the sphere of radius r in R^3
+    //    rand_in_disk(r)         a point in the disk of radius r in R^2
+    //    rand_in_ball(r)         a point in the ball of radius r in R^3
+    //    rand_quaternion()       a uniformly random rotation, as a unit
+    //                             quaternion { w, x, y, z }
+    //
+    // The methods: in two dimensions, a uniform angle; on the sphere,
+    // Archimedes' theorem (the z coordinate of a point on the sphere is
+    // uniform on [-1, 1]); in the disk and ball, a radius of r * u^(1/2)
+    // or r * u^(1/3); in N > 3 dimensions, N normal variates, made with
+    // the Box-Muller transform, and normalized; and for rotations,
+    // Shoemake's subgroup algorithm.
+    //
+    // Each point is returned as a std::array. The bulk overloads write
+    // n points to separate x, y, and z buffers (structure of arrays).
+    // They work in blocks of 256 points: the uniform variates of a
+    // block are drawn first, and then transformed, in loops without
+    // branches, that the compiler can vectorize. (With GCC, vectorized
+    // sin, cos, and log require glibc's libmvec, and -ffast-math.)
+    //
+    // Variates are drawn from the engine of thread_local
+    // tbx::rr<RealType>().
+    namespace detail
+    {
+        template <typename RealType>
+        RealType constexpr two_pi{ static_cast<RealType>(6.283'185'307'179'586'476'925'286'766'559L) };
+        //--------------------------------------------------------------
+        template <typename RealType>
+        inline void check_radius(RealType const radius, char const* const message)
+        {
+            static_assert(std::is_floating_point_v<RealType>, "");
+            if (!(RealType{ 0 } <= radius && radius <= std::numeric_limits<RealType>::max()))
+                throw std::invalid_argument(message);
+        }
+        //--------------------------------------------------------------
+        // Fill u[0..n) with uniform variates on [0, 1).
+        template <typename RealType, typename URBG>
+        inline void canonical_block(URBG& g, RealType* const u, std::size_t const n)
+        {
+            tbx::detail::generate_block(g, u, n, RealType{ 0 }, RealType{ 1 }, std::false_type{});
+        }
+        //--------------------------------------------------------------
+        template <typename RealType, typename URBG>
+        inline RealType canonical(URBG& g)  // on [0, 1)
+        {
+            RealType u;
+            tbx::detail::canonical_block(g, &u, 1u);
+            return u;
+        }
+    }
+    //------------------------------------------------------------------
+    template <std::size_t N, typename RealType = double>
+    inline std::array<RealType, N> rand_unit_vector()
+    {
+        static_assert(std::is_floating_point_v<RealType>, "");
+        static_assert(N > 0u, "");
+        auto& g{ tbx::rr<RealType>().urbg() };
+        std::array<RealType, N> v{};
+        if constexpr (N == 1u)
+        {
+            v[0] = tbx::detail::word32(g) & 1u ? RealType{ 1 } : RealType{ -1 };
+        }
+        else if constexpr (N == 2u)
+        {
+            auto const theta{ tbx::detail::two_pi<RealType> * tbx::detail::canonical<RealType>(g) };
+            v[0] = std::cos(theta);
+            v[1] = std::sin(theta);
+        }
+        else if constexpr (N == 3u)
+        {
+            auto const z{ RealType{ 1 } - RealType{ 2 } * tbx::detail::canonical<RealType>(g) };
+            auto const phi{ tbx::detail::two_pi<RealType> * tbx::detail::canonical<RealType>(g) };
+            auto const r{ std::sqrt(std::max(RealType{ 0 }, RealType{ 1 } - z * z)) };
+            v[0] = r * std::cos(phi);
+            v[1] = r * std::sin(phi);
+            v[2] = z;
+        }
+        else
+        {
+            // Box-Muller: each pair of uniform variates yields a pair of
+            // independent normal variates. A radius is never zero, so
+            // neither is the norm.
+            for (std::size_t i{}; i < N; i += 2u)
+            {
+                auto const r{ std::sqrt(RealType{ -2 } * static_cast<RealType>(std::log(tbx::detail::uniform_open01(g)))) };
+                auto const theta{ tbx::detail::two_pi<RealType> * tbx::detail::canonical<RealType>(g) };
+                v[i] = r * std::cos(theta);
+                if (i + 1u < N)
+                    v[i + 1u] = r * std::sin(theta);
+            }
+            RealType norm2{};
+            for (auto const x : v)
+                norm2 += x * x;
+            auto const scale{ RealType{ 1 } / std::sqrt(norm2) };
+            for (auto& x : v)
+                x *= scale;
+        }
+        return v;
+    }
+    //------------------------------------------------------------------
+    template <typename RealType = double>
+    inline std::array<RealType, 3u> rand_on_sphere(RealType const radius = RealType{ 1 })
+    {
+        tbx::detail::check_radius(radius,
+            "tbx::rand_on_sphere(radius): "
+            "requires a finite radius >= 0");
+        auto v{ tbx::rand_unit_vector<3u, RealType>() };
+        for (auto& x : v)
+            x *= radius;
+        return v;
+    }
+    //------------------------------------------------------------------
+    template <typename RealType = double>
+    inline std::array<RealType, 2u> rand_in_disk(RealType const radius = RealType{ 1 })
+    {
+        tbx::detail::check_radius(radius,
+            "tbx::rand_in_disk(radius): "
+            "requires a finite radius >= 0");
+        auto& g{ tbx::rr<RealType>().urbg() };
+        auto const r{ radius * std::sqrt(tbx::detail::canonical<RealType>(g)) };
+        auto const theta{ tbx::detail::two_pi<RealType> * tbx::detail::canonical<RealType>(g) };
+        return { r * std::cos(theta), r * std::sin(theta) };
+    }
+    //------------------------------------------------------------------
+    template <typename RealType = double>
+    inline std::array<RealType, 3u> rand_in_ball(RealType const radius = RealType{ 1 })
+    {
+        tbx::detail::check_radius(radius,
+            "tbx::rand_in_ball(radius): "
+            "requires a finite radius >= 0");
+        auto& g{ tbx::rr<RealType>().urbg() };
+        auto v{ tbx::rand_unit_vector<3u, RealType>() };
+        auto const r{ radius * std::cbrt(tbx::detail::canonical<RealType>(g)) };
+        for (auto& x : v)
+            x *= r;
+        return v;
+    }
+    //------------------------------------------------------------------
+    // Shoemake, "Uniform Random Rotations," Graphics Gems III (1992).
+    template <typename RealType = double>
+    inline std::array<RealType, 4u> rand_quaternion()
+    {
+        static_assert(std::is_floating_point_v<RealType>, "");
+        auto& g{ tbx::rr<RealType>().urbg() };
+        auto const u1{ tbx::detail::canonical<RealType>(g) };
+        auto const theta1{ tbx::detail::two_pi<RealType> * tbx::detail::canonical<RealType>(g) };
+        auto const theta2{ tbx::detail::two_pi<RealType> * tbx::detail::canonical<RealType>(g) };
+        auto const r1{ std::sqrt(RealType{ 1 } - u1) };
+        auto const r2{ std::sqrt(u1) };
+        return { r2 * std::cos(theta2), r1 * std::sin(theta1), r1 * std::cos(theta1), r2 * std::sin(theta2) };
+    }
+    //------------------------------------------------------------------
+    // Bulk overloads, writing structures of arrays
+    template <typename RealType>
+    inline void rand_on_sphere(RealType* x, RealType* y, RealType* z, std::size_t n, RealType const radius = RealType{ 1 })
+    {
+        tbx::detail::check_radius(radius,
+            "tbx::rand_on_sphere(x, y, z, n, radius): "
+            "requires a finite radius >= 0");
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        auto& g{ tbx::rr<RealType>().urbg() };
+        RealType u[block_size], v[block_size];
+        while (n)
+        {
+            auto const count{ n < block_size ? n : std::size_t{ block_size } };
+            tbx::detail::canonical_block(g, u, count);
+            tbx::detail::canonical_block(g, v, count);
+            for (std::size_t i{}; i < count; ++i)
+            {
+                auto const zi{ RealType{ 1 } - RealType{ 2 } * u[i] };
+                auto const phi{ tbx::detail::two_pi<RealType> * v[i] };
+                auto const r{ radius * std::sqrt(std::max(RealType{ 0 }, RealType{ 1 } - zi * zi)) };
+                x[i] = r * std::cos(phi);
+                y[i] = r * std::sin(phi);
+                z[i] = radius * zi;
+            }
+            x += count;
+            y += count;
+            z += count;
+            n -= count;
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename RealType>
+    inline void rand_in_disk(RealType* x, RealType* y, std::size_t n, RealType const radius = RealType{ 1 })
+    {
+        tbx::detail::check_radius(radius,
+            "tbx::rand_in_disk(x, y, n, radius): "
+            "requires a finite radius >= 0");
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        auto& g{ tbx::rr<RealType>().urbg() };
+        RealType u[block_size], v[block_size];
+        while (n)
+        {
+            auto const count{ n < block_size ? n : std::size_t{ block_size } };
+            tbx::detail::canonical_block(g, u, count);
+            tbx::detail::canonical_block(g, v, count);
+            for (std::size_t i{}; i < count; ++i)
+            {
+                auto const r{ radius * std::sqrt(u[i]) };
+                auto const theta{ tbx::detail::two_pi<RealType> * v[i] };
+                x[i] = r * std::cos(theta);
+                y[i] = r * std::sin(theta);
+            }
+            x += count;
+            y += count;
+            n -= count;
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename RealType>
+    inline void rand_in_ball(RealType* x, RealType* y, RealType* z, std::size_t n, RealType const radius = RealType{ 1 })
+    {
+        tbx::detail::check_radius(radius,
+            "tbx::rand_in_ball(x, y, z, n, radius): "
+            "requires a finite radius >= 0");
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        auto& g{ tbx::rr<RealType>().urbg() };
+        RealType u[block_size], v[block_size], w[block_size];
+        while (n)
+        {
+            auto const count{ n < block_size ? n : std::size_t{ block_size } };
+            tbx::detail::canonical_block(g, u, count);
+            tbx::detail::canonical_block(g, v, count);
+            tbx::detail::canonical_block(g, w, count);
+            for (std::size_t i{}; i < count; ++i)
+            {
+                auto const zi{ RealType{ 1 } - RealType{ 2 } * u[i] };
+                auto const phi{ tbx::detail::two_pi<RealType> * v[i] };
+                auto const r{ radius * std::cbrt(w[i]) };
+                auto const rho{ r * std::sqrt(std::max(RealType{ 0 }, RealType{ 1 } - zi * zi)) };
+                x[i] = rho * std::cos(phi);
+                y[i] = rho * std::sin(phi);
+                z[i] = r * zi;
+            }
+            x += count;
+            y += count;
+            z += count;
+            n -= count;
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename RealType>
+    inline void rand_quaternion(RealType* w, RealType* x, RealType* y, RealType* z, std::size_t n)
+    {
+        static_assert(std::is_floating_point_v<RealType>, "");
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        auto& g{ tbx::rr<RealType>().urbg() };
+        RealType u1[block_size], u2[block_size], u3[block_size];
+        while (n)
+        {
+            auto const count{ n < block_size ? n : std::size_t{ block_size } };
+            tbx::detail::canonical_block(g, u1, count);
+            tbx::detail::canonical_block(g, u2, count);
+            tbx::detail::canonical_block(g, u3, count);
+            for (std::size_t i{}; i < count; ++i)
+            {
+                auto const theta1{ tbx::detail::two_pi<RealType> * u2[i] };
+                auto const theta2{ tbx::detail::two_pi<RealType> * u3[i] };
+                auto const r1{ std::sqrt(RealType{ 1 } - u1[i]) };
+                auto const r2{ std::sqrt(u1[i]) };
+                w[i] = r2 * std::cos(theta2);
+                x[i] = r1 * std::sin(theta1);
+                y[i] = r1 * std::cos(theta1);
+                z[i] = r2 * std::sin(theta2);
+            }
+            w += count;
+            x += count;
+            y += count;
+            z += count;
+            n -= count;
+        }
+    }
+
+    //==================================================================
+    // rand_sorted, rand_sorted_range
+    //==================================================================
+    // tbx::rand_sorted<ResultType>(out, n, a, b) writes n uniform
+    // random values, in non-decreasing order. Their distribution is
+    // that of n calls to tbx::rand<ResultType>(a, b), followed by
+    // std::sort, but no sort is needed, and the cost is O(n).
+    //
+    //   std::vector<double> t(n);
+    //   tbx::rand_sorted(t.begin(), n, 0.0, 3'600.0);  // n event times, in order
+    //
+    // The values are made from normalized exponential spacings: when
+    // E[1], ..., E[n+1] are exponential variates, and S[i] is the sum
+    // of the first i, the values S[i] / S[n+1], for i = 1, ..., n, are
+    // the order statistics of n uniform variates on [0, 1). They are
+    // scaled to [a, b), or, for integral types, to [a, b + 1), and
+    // rounded down. S[n+1] must be known before the first value can be
+    // written. When out is a forward iterator, and ResultType is a
+    // floating-point type, and the value_type of out, the partial sums
+    // are written to out, and scaled in a second pass. Otherwise, the
+    // variates are summed, and then drawn a second time, from a copy
+    // of the engine.
+    //
+    // A rand_sorted_range<ResultType>(n, a, b) produces the same
+    // distribution, lazily, with O(1) memory, for n too large to
+    // store. Its iterators are input iterators, and like those of
+    // rand_range, must be used in the thread that constructed the
+    // range. Floating-point values are drawn one at a time from the
+    // remaining interval, using the distribution of the minimum of k
+    // uniform variates, 1 - U^(1/k). Integral values are made by
+    // sequential skip sampling. While k values remain to be drawn
+    // from the R integers of [v, b], the next integer to be drawn is
+    // v + j, where P(j >= i) = ((R - i) / R)^k, and it is drawn c
+    // times, where c is binomial(k, 1 / (R - j)), conditioned on
+    // c >= 1. Ties cost no extra draws.
+    //
+    // The spacings, skips, and minima are computed in floating point,
+    // so the distributions are exact only up to rounding. That matters
+    // only for integral ranges wider than 2^53.
+    //
+    // As with rand(a, b), a and b may be given in either order. For
+    // floating-point types, b - a must be finite. The values are
+    // drawn from the engine of thread_local tbx::rr<ResultType>().
+    namespace detail
+    {
+        // The working precision for sorted floating-point values
+        template <typename RealType>
+        using sorted_work_t = std::conditional_t<(sizeof(RealType) > sizeof(double)), RealType, double>;
+        //--------------------------------------------------------------
+        // The number of times, c >= 1, that the next integer is drawn,
+        // when k variates remain, and each takes it with probability p.
+        template <typename URBG>
+        inline std::uint64_t sorted_copies(URBG& g, std::uint64_t const k, double const p)
+        {
+            if (k == 1u || 1.0 <= p)
+                return k;
+            auto const kp{ static_cast<double>(k) * p };
+            if (1.0 <= kp)
+            {
+                // P(c == 0) = (1 - p)^k < 1/e
+                tbx::detail::binomial_sampler const binomial(k, p);
+                for (;;)
+                    if (auto const c{ binomial(g) })
+                        return c;
+            }
+            // Inversion, from c = 1. Few terms are needed, because the
+            // mean of c is less than 2.
+            auto const log_q{ std::log1p(-p) };
+            auto f{ kp * std::exp(static_cast<double>(k - 1u) * log_q) / -std::expm1(static_cast<double>(k) * log_q) };
+            auto u{ tbx::detail::canonical<double>(g) };
+            auto const r{ p / (1.0 - p) };
+            std::uint64_t c{ 1u };
+            while (f < u && c < k)
+            {
+                u -= f;
+                f *= static_cast<double>(k - c) / static_cast<double>(c + 1u) * r;
+                ++c;
+            }
+            return c;
+        }
+        //--------------------------------------------------------------
+        // 1 - U^(1/k): the minimum of k uniform variates on [0, 1)
+        template <typename RealType, typename URBG>
+        inline RealType sorted_min(URBG& g, std::uint64_t const k)
+        {
+            auto const u{ RealType{ 1 } - tbx::detail::canonical<RealType>(g) };  // on (0, 1]
+            return -std::expm1(std::log(u) / static_cast<RealType>(k));
+        }
+        //--------------------------------------------------------------
+        // Sorted values, one at a time, on [a, b] for integral types,
+        // and on [a, b) for floating-point types
+        template <typename T, bool = tbx::is_integral_v<T>>
+        class sorted_sampler
+        {
+            std::uint64_t k_;          // values not yet drawn
+            std::uint64_t base_;       // a
+            std::uint64_t offset_{};   // of the lowest integer not yet considered
+            std::uint64_t last_;       // b - a
+            std::uint64_t copies_{};   // of value_, still to be returned
+            T value_{};
+        public:
+            sorted_sampler(std::uint64_t const n, T const a, T const b) noexcept
+                : k_{ n }
+                , base_{ static_cast<std::uint64_t>(a) }
+                , last_{ static_cast<std::uint64_t>(b) - static_cast<std::uint64_t>(a) }
+            {}
+            std::uint64_t size() const noexcept { return k_ + copies_; }
+            template <typename URBG>
+            T operator()(URBG& g)
+            {
+                if (copies_ == 0u)
+                {
+                    auto const span{ last_ - offset_ };  // R - 1
+                    auto const x{ std::floor((static_cast<double>(span) + 1.0) * tbx::detail::sorted_min<double>(g, k_)) };
+                    auto const j{ x < static_cast<double>(span) ? static_cast<std::uint64_t>(x) : span };
+                    offset_ += j;
+                    value_ = static_cast<T>(base_ + offset_);
+                    copies_ = tbx::detail::sorted_copies(g, k_, 1.0 / (static_cast<double>(span - j) + 1.0));
+                    k_ -= copies_;
+                    if (offset_ < last_)
+                        ++offset_;
+                }
+                --copies_;
+                return value_;
+            }
+        };
+        template <typename T>
+        class sorted_sampler<T, false>
+        {
+            using work_type = tbx::detail::sorted_work_t<T>;
+            std::uint64_t k_;
+            work_type x_{};            // the last value, on [0, 1)
+            T a_;
+            work_type width_;
+            T below_b_;
+        public:
+            sorted_sampler(std::uint64_t const n, T const a, T const b)
+                : k_{ n }
+                , a_{ a }
+                , width_{ static_cast<work_type>(b) - static_cast<work_type>(a) }
+                , below_b_{ std::nextafter(b, a) }
+            {}
+            std::uint64_t size() const noexcept { return k_; }
+            template <typename URBG>
+            T operator()(URBG& g)
+            {
+                x_ += (work_type{ 1 } - x_) * tbx::detail::sorted_min<work_type>(g, k_--);
+                auto const y{ static_cast<T>(a_ + x_ * width_) };
+                return y < below_b_ ? y : below_b_;
+            }
+        };
+        //--------------------------------------------------------------
+        // The width, b - a, is computed in the working precision. It
+        // is not finite when a or b is not.
+        template <typename T>
+        inline void check_sorted_range(T const a, T const b, char const* const message)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                using work_type = tbx::detail::sorted_work_t<T>;
+                auto const width{ std::abs(static_cast<work_type>(b) - static_cast<work_type>(a)) };
+                if (!(width <= std::numeric_limits<work_type>::max() && a != b))
+                    throw std::invalid_argument(message);
+            }
+        }
+        template <typename T>
+        auto constexpr sorted_default_b() noexcept
+        {
+            return std::is_floating_point_v<T> ? T{ 1 } : std::numeric_limits<T>::max();
+        }
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType, typename OutputIt>
+    inline OutputIt rand_sorted(OutputIt out, std::size_t const n, ResultType a, ResultType b)
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+        tbx::detail::check_sorted_range(a, b,
+            "tbx::rand_sorted(out, n, a, b): "
+            "floating-point arguments require a != b, and a finite b - a");
+        if (b < a)
+            std::swap(a, b);
+        using work_type = tbx::detail::sorted_work_t<ResultType>;
+        enum : std::size_t { block_size = tbx::detail::bulk_block_size };
+        auto& g{ tbx::rr<ResultType>().urbg() };
+
+        // Fill e with the exponential variates of a block.
+        auto exponentials = [n](auto& g, work_type* const e, std::size_t const done) {
+            auto const count{ n + 1u - done < block_size ? n + 1u - done : std::size_t{ block_size } };
+            tbx::detail::canonical_block(g, e, count);
+            for (std::size_t i{}; i < count; ++i)
+                e[i] = -std::log1p(-e[i]);
+            return count;
+        };
+
+        work_type e[block_size];
+        work_type sum{};
+        if constexpr (std::is_floating_point_v<ResultType> && std::is_base_of_v<std::forward_iterator_tag,
+            typename std::iterator_traits<OutputIt>::iterator_category>
+            && std::is_same_v<typename std::iterator_traits<OutputIt>::value_type, ResultType>)
+        {
+            // Write the partial sums, and then scale them in place.
+            auto it{ out };
+            for (std::size_t done{}; done <= n; )
+            {
+                auto const count{ exponentials(g, e, done) };
+                for (std::size_t i{}; i < count; ++i, ++done)
+                {
+                    sum += e[i];
+                    if (done < n)
+                        *it++ = static_cast<ResultType>(sum);
+                }
+            }
+            auto const scale{ (static_cast<work_type>(b) - static_cast<work_type>(a)) / sum };
+            auto const below_b{ std::nextafter(b, a) };
+            for (std::size_t i{}; i < n; ++i, ++out)
+            {
+                auto const y{ static_cast<ResultType>(a + static_cast<work_type>(*out) * scale) };
+                *out = y < below_b ? y : below_b;
+            }
+            return out;
+        }
+
+        // Otherwise, the first pass sums the n + 1 variates. The second
+        // pass draws the same variates again, from a copy of the
+        // engine, and writes the scaled partial sums.
+        auto replay{ g };
+        for (std::size_t done{}; done <= n; )
+        {
+            auto const count{ exponentials(g, e, done) };
+            for (std::size_t i{}; i < count; ++i)
+                sum += e[i];
+            done += count;
+        }
+        if constexpr (tbx::is_integral_v<ResultType>)
+        {
+            auto const base{ static_cast<std::uint64_t>(a) };
+            auto const last{ static_cast<std::uint64_t>(b) - base };
+            auto const scale{ (static_cast<work_type>(last) + work_type{ 1 }) / sum };
+            work_type partial{};
+            for (std::size_t done{}; done < n; )
+            {
+                auto const count{ exponentials(replay, e, done) };
+                for (std::size_t i{}; i < count && done < n; ++i, ++done)
+                {
+                    auto const x{ std::floor((partial += e[i]) * scale) };
+                    *out++ = static_cast<ResultType>(base + (x < static_cast<work_type>(last) ? static_cast<std::uint64_t>(x) : last));
+                }
+            }
+        }
+        else
+        {
+            // Scaling and rounding preserve the order.
+            auto const scale{ (static_cast<work_type>(b) - static_cast<work_type>(a)) / sum };
+            auto const below_b{ std::nextafter(b, a) };
+            work_type partial{};
+            for (std::size_t done{}; done < n; )
+            {
+                auto const count{ exponentials(replay, e, done) };
+                for (std::size_t i{}; i < count && done < n; ++i, ++done)
+                {
+                    auto const y{ static_cast<ResultType>(a + (partial += e[i]) * scale) };
+                    *out++ = y < below_b ? y : below_b;
+                }
+            }
+        }
+        return out;
+    }
+    template <typename ResultType, typename OutputIt>
+    inline OutputIt rand_sorted(OutputIt out, std::size_t const n)
+    {
+        return tbx::rand_sorted(out, n, ResultType{}, tbx::detail::sorted_default_b<ResultType>());
+    }
+    //------------------------------------------------------------------
+    template <typename ResultType>
+    class rand_sorted_range;
+
+    template <typename ResultType>
+    class rand_sorted_iterator
+    {
+        tbx::rand_sorted_range<ResultType>* r_{};
+        class postfix_proxy
+        {
+            ResultType value_;
+        public:
+            explicit postfix_proxy(ResultType const value) noexcept
+                : value_{ value }
+            {}
+            ResultType operator*() const noexcept { return value_; }
+        };
+        bool at_end() const noexcept { return !r_ || r_->empty(); }
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ResultType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+        rand_sorted_iterator() noexcept
+            = default;
+        explicit rand_sorted_iterator(tbx::rand_sorted_range<ResultType>& r) noexcept
+            : r_{ &r }
+        {}
+        reference operator*() const             { return r_->current(); }
+        pointer operator->() const              { return &r_->current(); }
+        rand_sorted_iterator& operator++()      { r_->advance(); return *this; }
+        postfix_proxy operator++(int) { postfix_proxy const p{ **this }; r_->advance(); return p; }
+
+        // Every iterator of an exhausted range equals an end iterator.
+        friend bool operator==(rand_sorted_iterator const& a, rand_sorted_iterator const& b) noexcept
+        {
+            return (a.at_end() && b.at_end()) || a.r_ == b.r_;
+        }
+        friend bool operator!=(rand_sorted_iterator const& a, rand_sorted_iterator const& b) noexcept { return !(a == b); }
+    };
+
+    template <typename ResultType>
+    class rand_sorted_range
+    {
+        static_assert(tbx::is_arithmetic_v<ResultType>, "");
+    public:
+        using result_type = ResultType;
+        using iterator = tbx::rand_sorted_iterator<ResultType>;
+    private:
+        friend class tbx::rand_sorted_iterator<ResultType>;
+        typename tbx::rand_replacement<ResultType>::urbg_type& g_;
+        tbx::detail::sorted_sampler<ResultType> s_;
+        bool fresh_{ true };       // current_ has not been drawn
+        result_type current_{};
+    public:
+        explicit rand_sorted_range(std::uint64_t const n)
+            : rand_sorted_range(n, result_type{}, tbx::detail::sorted_default_b<result_type>())
+        {}
+        rand_sorted_range(std::uint64_t const n, result_type const a, result_type const b)
+            : g_{ tbx::rr<ResultType>().urbg() }
+            , s_{ n, check(a, b), b < a ? a : b }
+        {}
+        rand_sorted_range(rand_sorted_range const&)
+            = delete;
+        rand_sorted_range& operator=(rand_sorted_range const&)
+            = delete;
+        iterator begin()                    { return iterator{ *this }; }
+        iterator end() noexcept             { return iterator{}; }
+        bool empty() const noexcept         { return fresh_ && s_.size() == 0u; }
+        std::uint64_t size() const noexcept { return s_.size() + !fresh_; }  // values not yet passed
+    private:
+        result_type const& current()
+        {
+            if (fresh_)
+            {
+                current_ = s_(g_);
+                fresh_ = false;
+            }
+            return current_;
+        }
+        void advance()
+        {
+            current();
+            fresh_ = true;
+        }
+        auto static check(result_type const a, result_type const b)
+        {
+            tbx::detail::check_sorted_range(a, b,
+                "tbx::rand_sorted_range<ResultType>::rand_sorted_range(n, a, b): "
+                "floating-point arguments require a != b, and a finite b - a");
+            return b < a ? b : a;
+        }
+    };
+
+    //==================================================================
+    // rand_mask, stochastic_round_int8, stochastic_round_bf16
+    //==================================================================
+    // Bulk routines for preprocessing tensors, which turn engine words
+    // into results directly, with no distribution, and no conversion of
+    // random words to floating point. Their inner loops are bulk
+    // kernels (see bulk_isa).
+    //
+    //    rand_mask(mask, n, keep)   set each of n bits with probability
+    //                                keep, e.g., for a dropout mask
+    //
+    // Bit i is bit i % 64 of mask[i / 64]. Bits past n, in the last
+    // word, are cleared. keep is a probability, or a bernoulli_param.
+    // When keep is dyadic, k / 2^m, a mask word is folded out of m
+    // random words, by "and" and "or," so each bit costs m random
+    // bits: one bit when keep is 1/2, four when it is 13/16. Any other
+    // keep costs a 32-bit word per bit, which is compared with the
+    // threshold of the bernoulli_param. Masks are drawn from the
+    // engine of rand<bool>(), and seeded with srand<bool>().
+    //
+    //    stochastic_round_int8(in, out, n, scale)
+    //    stochastic_round_bf16(in, out, n)
+    //
+    // Stochastic rounding rounds x up with a probability equal to its
+    // distance from the value below, and down otherwise, so that the
+    // expected result is x. Each element costs 16 random bits.
+    //
+    // stochastic_round_int8 rounds in[i] * scale (scale defaults to 1)
+    // to an integer on [-128, 127], saturating values outside that
+    // range. NaN becomes 0. The fraction is taken to 16 bits, so the
+    // result is unbiased when the fraction of in[i] * scale is a
+    // multiple of 2^-16. Otherwise, the probability of rounding up
+    // differs from the fraction by less than 2^-16.
+    //
+    // stochastic_round_bf16 rounds floats to bfloat16 (the high 16 bits
+    // of a float), returned as the bit patterns, in std::uint16_t. It
+    // adds 16 random bits to the 16 bits that are dropped, so the
+    // result is exactly unbiased. Infinity stays infinity, and NaN
+    // stays NaN. Values above the largest bfloat16 may round to
+    // infinity.
+    //
+    // Both functions draw from the engine of rand<float>(), and are
+    // seeded with srand<float>().
+    namespace detail
+    {
+        enum : std::size_t { mask_block_size = 16u };  // mask words
+        //--------------------------------------------------------------
+        // Each bit of a mask word is set with probability k / 2^m, for
+        // odd k. Reading the bits of k from the lowest, fold in one
+        // random word per bit: "or" for a 1, and "and" for a 0. The
+        // m rows of random words hold n words each.
+        struct dyadic_mask_kernel
+        {
+            bool static constexpr const floating_point{ false };
+            TBX_RAND_KERNEL_BODY
+            static void body(std::uint64_t const* const words, std::uint64_t* const mask, std::size_t const n
+                , std::uint32_t const k, unsigned const m) noexcept
+            {
+                for (std::size_t j{}; j < n; ++j)
+                    mask[j] = words[j];
+                for (unsigned d{ 1u }; d < m; ++d)
+                {
+                    auto const* const row{ words + d * n };
+                    if (k >> d & 1u)
+                        for (std::size_t j{}; j < n; ++j)
+                            mask[j] |= row[j];
+                    else
+                        for (std::size_t j{}; j < n; ++j)
+                            mask[j] &= row[j];
+                }
+            }
+        };
+        //--------------------------------------------------------------
+        // Bit b of mask word j is set when word 64 * j + b is below
+        // high. Return nonzero when some word equals high, which
+        // leaves its bit to be decided by a second word.
+        struct threshold_mask_kernel
+        {
+            bool static constexpr const floating_point{ false };
+            TBX_RAND_KERNEL_BODY
+            static std::uint32_t body(std::uint32_t const* const words, std::uint64_t* const mask, std::size_t const n
+                , std::uint32_t const high) noexcept
+            {
+                std::uint32_t ties{};
+                for (std::size_t j{}; j < n; ++j)
+                {
+                    auto const* const w{ words + 64u * j };
+                    std::uint64_t bits{};
+                    for (unsigned b{}; b < 64u; ++b)
+                    {
+                        bits |= std::uint64_t{ w[b] < high } << b;
+                        ties |= w[b] == high;
+                    }
+                    mask[j] = bits;
+                }
+                return ties;
+            }
+        };
+        //--------------------------------------------------------------
+        template <typename URBG>
+        inline void fill_bits16(URBG& g, std::uint16_t* const bits, std::size_t const n)
+        {
+            for (std::size_t i{}; i < n; i += 2u)
+            {
+                auto const w{ tbx::detail::word32(g) };
+                bits[i] = static_cast<std::uint16_t>(w);
+                if (i + 1u < n)
+                    bits[i + 1u] = static_cast<std::uint16_t>(w >> 16);
+            }
+        }
+        //--------------------------------------------------------------
+        struct round_int8_kernel
+        {
+            bool static constexpr const floating_point{ true };
+            TBX_RAND_KERNEL_BODY
+            static void body(float const* const in, std::uint16_t const* const bits, std::int8_t* const out
+                , std::size_t const n, float const scale) noexcept
+            {
+                // In fixed point, with 16 fractional bits, offset so that
+                // -128 is 0: adding 16 random bits, and truncating,
+                // rounds up with a probability equal to the fraction.
+                // (All arithmetic on y precedes the clamps. Otherwise,
+                // GCC threads the paths of the clamps, and gives up on
+                // vectorizing the loop.)
+                float constexpr one{ 65'536.0f };
+                for (std::size_t i{}; i < n; ++i)
+                {
+                    auto y{ (in[i] * scale + 128.0f) * one };
+                    y = y == y ? y : 128.0f * one;
+                    y = y > 0.0f ? y : 0.0f;
+                    y = y < 255.0f * one ? y : 255.0f * one;
+                    out[i] = static_cast<std::int8_t>(((static_cast<int>(y) + bits[i]) >> 16) - 128);
+                }
+            }
+        };
+        //--------------------------------------------------------------
+        struct round_bf16_kernel
+        {
+            bool static constexpr const floating_point{ false };
+            TBX_RAND_KERNEL_BODY
+            static void body(float const* const in, std::uint16_t const* const bits, std::uint16_t* const out
+                , std::size_t const n) noexcept
+            {
+                static_assert(sizeof(float) == sizeof(std::uint32_t), "");
+                for (std::size_t i{}; i < n; ++i)
+                {
+                    std::uint32_t u;
+                    std::memcpy(&u, in + i, sizeof u);
+                    auto const is_nan{ (u & 0x7fff'ffffu) > 0x7f80'0000u };
+                    auto const rounded{ (u + bits[i]) >> 16 };
+                    out[i] = static_cast<std::uint16_t>(is_nan ? u >> 16 | 0x0040u : rounded);
+                }
+            }
+        };
+        //--------------------------------------------------------------
+        template <typename Kernel, typename Out, typename... Args>
+        inline void stochastic_round_blocks(float const* const in, Out* const out, std::size_t const n, Args const... args)
+        {
+            auto& g{ tbx::rr<float>().urbg() };
+            std::uint16_t bits[bulk_block_size];
+            for (std::size_t done{}; done < n; done += bulk_block_size)
+            {
+                auto const count{ n - done < bulk_block_size ? n - done : std::size_t{ bulk_block_size } };
+                tbx::detail::fill_bits16(g, bits, count);
+                tbx::detail::dispatch<Kernel>(in + done, static_cast<std::uint16_t const*>(bits), out + done, count, args...);
+            }
+        }
+    }
+    //------------------------------------------------------------------
+    inline void rand_mask(std::uint64_t* const mask, std::size_t const n, tbx::bernoulli_param const& keep)
+    {
+        auto& g{ tbx::rr<bool>().urbg() };
+        auto const n_words{ n / 64u + (n % 64u != 0u) };
+        auto const m{ keep.dyadic_bits() };
+        if (m == 0u)
+        {
+            auto const fill{ keep.dyadic_numerator() ? ~std::uint64_t{} : std::uint64_t{} };
+            for (std::size_t j{}; j < n_words; ++j)
+                mask[j] = fill;
+        }
+        else if (m != tbx::bernoulli_param::not_dyadic)
+        {
+            std::size_t constexpr block{ tbx::detail::mask_block_size };
+            std::uint64_t words[block * 32u];
+            for (std::size_t done{}; done < n_words; done += block)
+            {
+                auto const count{ n_words - done < block ? n_words - done : block };
+                tbx::detail::fill_words(g, words, count * m);
+                tbx::detail::dispatch<tbx::detail::dyadic_mask_kernel>(static_cast<std::uint64_t const*>(words), mask + done, count
+                    , keep.dyadic_numerator(), m);
+            }
+        }
+        else
+        {
+            std::size_t constexpr block{ tbx::detail::mask_block_size };
+            auto const high{ static_cast<std::uint32_t>(keep.threshold_high()) };
+            std::uint32_t words[block * 64u];
+            for (std::size_t done{}; done < n_words; done += block)
+            {
+                auto const count{ n_words - done < block ? n_words - done : block };
+                tbx::detail::fill_words(g, words, count * 64u);
+                if (tbx::detail::dispatch<tbx::detail::threshold_mask_kernel>(static_cast<std::uint32_t const*>(words), mask + done, count, high))
+                {
+                    for (std::size_t i{}; i < count * 64u; ++i)
+                        if (words[i] == high)
+                        {
+                            auto const bit{ std::uint64_t{ 1u } << i % 64u };
+                            auto& word{ mask[done + i / 64u] };
+                            word = tbx::detail::word32(g) < keep.threshold_low() ? word | bit : word & ~bit;
+                        }
+                }
+            }
+        }
+        if (n % 64u != 0u)
+            mask[n_words - 1u] &= (std::uint64_t{ 1u } << n % 64u) - 1u;
+    }
+    inline void rand_mask(std::uint64_t* const mask, std::size_t const n, double const keep)
+    {
+        tbx::rand_mask(mask, n, tbx::bernoulli_param{ keep });
+    }
+    //------------------------------------------------------------------
+    inline void stochastic_round_int8(float const* const in, std::int8_t* const out, std::size_t const n, float const scale = 1.0f)
+    {
+        tbx::detail::stochastic_round_blocks<tbx::detail::round_int8_kernel>(in, out, n, scale);
+    }
+    inline void stochastic_round_bf16(float const* const in, std::uint16_t* const out, std::size_t const n)
+    {
+        tbx::detail::stochastic_round_blocks<tbx::detail::round_bf16_kernel>(in, out, n);
+    }
 }   // end namespace tbx
+
+//======================================================================
+// Explicit instantiations (opt-in: #define TBX_RAND_EXTERN_TEMPLATES)
+//======================================================================
+// Every translation unit that calls tbx::rand<int>() instantiates
+// rand_replacement<int>, its engine and distribution, and the rand()
+// family, only for the linker to discard all but one copy.
+//
+// tbx.rand.cpp instantiates them once, for each of the fundamental
+// types that rand() accepts. When TBX_RAND_EXTERN_TEMPLATES is
+// defined, the declarations below tell the compiler not to repeat
+// that work, and the program must be linked with tbx.rand.cpp. It
+// must be compiled with the same feature macros (for instance,
+// TBX_RAND_ENGINE_POOL) as the rest of the program.
+//
+// Aliases such as std::int64_t name one of these types, and are
+// covered too.
+#define TBX_RAND_INSTANTIATIONS(prefix, T)                                      \
+    prefix template class tbx::rand_replacement<T>;                             \
+    prefix template tbx::rand_replacement<T>& tbx::rr<T>();                     \
+    prefix template T tbx::rand<T>();                                           \
+    prefix template T tbx::rand<T>(T const, T const);                           \
+    prefix template T tbx::rand<T>(tbx::param_type<T> const);                   \
+    prefix template T tbx::rand_max<T>();                                       \
+    prefix template void tbx::srand<T>();                                       \
+    prefix template void tbx::srand<T>(std::uint_fast32_t const);               \
+    prefix template void tbx::srand<T>(std::seed_seq const&);                   \
+    prefix template void tbx::srand<T, std::seed_seq, void>(std::seed_seq&);
+
+#define TBX_RAND_INSTANTIATIONS_ALL(prefix)                                     \
+    TBX_RAND_INSTANTIATIONS(prefix, bool)                                       \
+    TBX_RAND_INSTANTIATIONS(prefix, char)                                       \
+    TBX_RAND_INSTANTIATIONS(prefix, signed char)                                \
+    TBX_RAND_INSTANTIATIONS(prefix, short)                                      \
+    TBX_RAND_INSTANTIATIONS(prefix, int)                                        \
+    TBX_RAND_INSTANTIATIONS(prefix, long)                                       \
+    TBX_RAND_INSTANTIATIONS(prefix, long long)                                  \
+    TBX_RAND_INSTANTIATIONS(prefix, unsigned char)                              \
+    TBX_RAND_INSTANTIATIONS(prefix, unsigned short)                             \
+    TBX_RAND_INSTANTIATIONS(prefix, unsigned int)                               \
+    TBX_RAND_INSTANTIATIONS(prefix, unsigned long)                              \
+    TBX_RAND_INSTANTIATIONS(prefix, unsigned long long)                         \
+    TBX_RAND_INSTANTIATIONS(prefix, float)                                      \
+    TBX_RAND_INSTANTIATIONS(prefix, double)                                     \
+    TBX_RAND_INSTANTIATIONS(prefix, long double)
+
+#if defined(TBX_RAND_EXTERN_TEMPLATES)
+TBX_RAND_INSTANTIATIONS_ALL(extern)
+#endif
 #endif  // TBX_RAND_H
 // end file: tbx.rand.h
@@ -21,16 +21,29 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //================================================================================
+#include <algorithm>    // adjacent_find, copy_n, equal, fill, is_sorted, sort, transform
 #include <array>        // array
+#include <atomic>       // atomic
 #include <cassert>      // assert
+#include <cmath>        // abs, ceil, floor, isnan, ldexp, sqrt
 #include <cstddef>      // size_t
-#include <cstdint>      // int16_t, int32_t, int64_t, uint16_t, uint32_t, uint64_t
+#include <cstdint>      // int8_t, int16_t, int32_t, int64_t, uint16_t, uint32_t, uint64_t
+#include <cstdio>       // remove
+#include <cstring>      // memcpy
+#include <functional>   // plus
 #include <iostream>     // basic_ostream
+#include <iterator>     // back_inserter
 #include <limits>       // numeric_limits
-#include <random>       // mt19937, seed_seq, uniform_int_distribution
+#include <list>         // list
+#include <numeric>      // iota
+#include <random>       // generate_canonical, mt19937, seed_seq, uniform_int_distribution
+#include <stdexcept>    // invalid_argument
 #include <string>       // char_traits, string
 #include <thread>       // thread
+#include <tuple>        // get, make_tuple
 #include <type_traits>  // is_floating_point_v, is_same_v, is_unsigned_v
+#include <utility>      // declval
+#include <vector>       // vector
 
 #include "tbx.rand.h"
 
@@ -873,6 +886,2684 @@ namespace
     }
 }
 //======================================================================
+// Test Routines - shuffle
+//======================================================================
+namespace
+{
+    bool shuffle__test_permutation()
+    {
+        // Every element must survive the shuffle, exactly once. The
+        // sizes straddle the thresholds where the batch size changes.
+        auto pass{ true };
+        for (std::size_t const n : { 0u, 1u, 2u, 3u, 7u, 100u, 1'025u, 4'097u, 40'000u })
+        {
+            std::vector<std::size_t> v(n);
+            std::iota(v.begin(), v.end(), std::size_t{});
+            tbx::shuffle(v.begin(), v.end());
+            std::vector<bool> seen(n);
+            for (auto const i : v)
+            {
+                pass = i < n && !seen[i] && pass;
+                if (i < n)
+                    seen[i] = true;
+            }
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool shuffle__test_srand__seed()
+    {
+        std::vector<int> v1(1000), v2(1000);
+        std::iota(v1.begin(), v1.end(), 0);
+        std::iota(v2.begin(), v2.end(), 0);
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        tbx::srand<std::size_t>(arbitrary_seed);
+        tbx::shuffle(v1.begin(), v1.end());
+        tbx::srand<std::size_t>(arbitrary_seed);
+        tbx::shuffle(v2.begin(), v2.end());
+        auto const pass{ v1 == v2 };
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool shuffle__test_uniformity()
+    {
+        // Shuffle {0, 1, 2, 3} many times, and count how often each of
+        // the 24 permutations turns up. The tolerance is about eight
+        // standard deviations.
+        enum : int { n_perms = 24, n_trials = 240'000, expected = n_trials / n_perms, tolerance = 800 };
+        std::array<int, 256> count{};
+        for (int i{ n_trials }; i--;)
+        {
+            std::array<unsigned char, 4> a{ 0, 1, 2, 3 };
+            tbx::shuffle(a.begin(), a.end());
+            ++count[a[0] << 6 | a[1] << 4 | a[2] << 2 | a[3]];
+        }
+        auto pass{ true };
+        int n_seen{};
+        for (auto const c : count)
+            if (c)
+            {
+                ++n_seen;
+                pass = c > expected - tolerance && c < expected + tolerance && pass;
+            }
+        pass = n_seen == n_perms && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool shuffle__test_non_trivial()
+    {
+        // Elements that are not trivially copyable, and an explicit engine.
+        std::vector<std::string> v{ "zero", "one", "two", "three", "four", "five", "six", "seven" };
+        auto sorted{ v };
+        std::mt19937 eng{ ::make_arbitrary_seed() };
+        tbx::shuffle(v.begin(), v.end(), eng);
+        std::sort(v.begin(), v.end());
+        std::sort(sorted.begin(), sorted.end());
+        auto const pass{ v == sorted };
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - shuffle
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_shuffle(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::shuffle__test_permutation  () && pass;
+        pass = ::shuffle__test_srand__seed  () && pass;
+        pass = ::shuffle__test_uniformity   () && pass;
+        pass = ::shuffle__test_non_trivial  () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::shuffle \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - sample_indices
+//======================================================================
+namespace
+{
+    bool sample_indices__test_distinct(std::uint64_t const n, std::size_t const k, bool const sorted)
+    {
+        std::vector<std::uint64_t> v(k);
+        tbx::sample_indices(v.begin(), v.end(), n, sorted);
+        auto pass{ true };
+        for (auto const i : v)
+            pass = i < n && pass;
+        if (sorted)
+            pass = std::is_sorted(v.begin(), v.end()) && pass;
+        std::sort(v.begin(), v.end());
+        pass = std::adjacent_find(v.begin(), v.end()) == v.end() && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool sample_indices__test_distinct()
+    {
+        // The cases exercise each of the algorithms: Method D (sorted),
+        // Method A (the tail end of Method D), Floyd's algorithm, Method D
+        // followed by a shuffle, and the partial Fisher-Yates shuffle.
+        auto pass{ true };
+        for (auto const sorted : { false, true })
+        {
+            pass = ::sample_indices__test_distinct(1u, 1u, sorted) && pass;
+            pass = ::sample_indices__test_distinct(20u, 10u, sorted) && pass;
+            pass = ::sample_indices__test_distinct(20u, 20u, sorted) && pass;
+            pass = ::sample_indices__test_distinct(100'000u, 50u, sorted) && pass;
+            pass = ::sample_indices__test_distinct(100'000u, 2'000u, sorted) && pass;
+            pass = ::sample_indices__test_distinct(100'000u, 60'000u, sorted) && pass;
+            pass = ::sample_indices__test_distinct(std::uint64_t{ 1u } << 40, 100u, sorted) && pass;
+        }
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool sample_indices__test_uniformity(std::uint64_t const n, std::size_t const k, bool const sorted)
+    {
+        // Every index should be selected about n_trials * k / n times.
+        // The tolerance is about eight standard deviations.
+        enum : int { n_trials = 40'000 };
+        std::vector<int> count(n);
+        std::vector<int> v(k);
+        for (int i{ n_trials }; i--;)
+        {
+            tbx::sample_indices(v.begin(), v.end(), n, sorted);
+            for (auto const j : v)
+                ++count[j];
+        }
+        auto const p{ static_cast<double>(k) / n };
+        auto const expected{ n_trials * p };
+        auto const tolerance{ 8.0 * std::sqrt(expected * (1.0 - p)) + 1.0 };
+        auto pass{ true };
+        for (auto const c : count)
+            pass = std::abs(c - expected) < tolerance && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool sample_indices__test_uniformity()
+    {
+        auto pass{ true };
+        pass = ::sample_indices__test_uniformity(10u, 3u, false) && pass;   // Fisher-Yates
+        pass = ::sample_indices__test_uniformity(10u, 3u, true) && pass;    // Method A
+        pass = ::sample_indices__test_uniformity(200u, 5u, false) && pass;  // Floyd
+        pass = ::sample_indices__test_uniformity(200u, 5u, true) && pass;   // Method D
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool sample_indices__test_invalid_argument()
+    {
+        std::array<int, 4> a{};
+        auto pass{ false };
+        try
+        {
+            tbx::sample_indices(a.begin(), a.end(), 3u);
+        }
+        catch (std::invalid_argument const&)
+        {
+            pass = true;
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - sample_indices
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_sample_indices(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::sample_indices__test_distinct         () && pass;
+        pass = ::sample_indices__test_uniformity       () && pass;
+        pass = ::sample_indices__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::sample_indices \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - random_permutation
+//======================================================================
+namespace
+{
+    bool random_permutation__test_bijection(std::uint64_t const n)
+    {
+        // Each index in [0, n) must appear exactly once, whether the
+        // permutation is evaluated by operator[], by iterator, or in
+        // batches.
+        tbx::random_permutation const p(n, ::make_arbitrary_seed());
+        std::vector<bool> seen(n);
+        std::vector<std::uint64_t> indices(n), batch(n);
+        std::iota(indices.begin(), indices.end(), std::uint64_t{});
+        p.map(indices.begin(), indices.end(), batch.begin());
+        auto pass{ p.size() == n };
+        std::uint64_t i{};
+        for (auto const x : p)
+        {
+            pass = x < n && !seen[x] && x == p[i] && x == batch[i] && pass;
+            if (x < n)
+                seen[x] = true;
+            ++i;
+        }
+        pass = i == n && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool random_permutation__test_bijection()
+    {
+        auto pass{ true };
+        for (std::uint64_t const n : { 1u, 2u, 3u, 5u, 1'000u, 1'023u, 1'024u, 1'025u, 65'537u })
+            pass = ::random_permutation__test_bijection(n) && pass;
+
+        // An empty index space is rejected, rather than walked forever.
+        auto threw{ false };
+        try { tbx::random_permutation const p(0u); }
+        catch (std::invalid_argument const&) { threw = true; }
+        pass = threw && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool random_permutation__test_srand()
+    {
+        enum : std::uint64_t { n = 10'000u };
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        tbx::random_permutation p1(n, arbitrary_seed), p2(n), p3(n);
+        p2.srand(arbitrary_seed);
+        p3.srand(arbitrary_seed + 1u);
+        std::seed_seq sseq{ 1, 3, 5, 7, 11, 13, 17, 19, 23, 29 };
+        tbx::random_permutation p4(n), p5(n);
+        p4.srand(sseq);
+        p5.srand(sseq);
+        auto pass{ std::equal(p1.begin(), p1.end(), p2.begin()) };
+        pass = !std::equal(p1.begin(), p1.end(), p3.begin()) && pass;
+        pass = std::equal(p4.begin(), p4.end(), p5.begin()) && pass;
+        pass = !std::equal(p1.begin(), p1.end(), p4.begin()) && pass;
+        tbx::random_permutation p6(n), p7(n, 1u);
+        pass = std::equal(p6.begin(), p6.end(), p7.begin()) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool random_permutation__test_huge()
+    {
+        // A key space of 2^40 cannot be checked exhaustively, but a
+        // slice of it can be checked for range and repeats.
+        auto constexpr n{ std::uint64_t{ 1u } << 40 };
+        tbx::random_permutation p(n);
+        p.srand();
+        std::vector<std::uint64_t> v;
+        for (auto const x : p.slice(n - 5'000u, n))
+            v.push_back(x);
+        auto pass{ v.size() == 5'000u };
+        for (auto const x : v)
+            pass = x < n && pass;
+        std::sort(v.begin(), v.end());
+        pass = std::adjacent_find(v.begin(), v.end()) == v.end() && pass;
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - random_permutation
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_random_permutation(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::random_permutation__test_bijection () && pass;
+        pass = ::random_permutation__test_srand     () && pass;
+        pass = ::random_permutation__test_huge      () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::random_permutation \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - rand_range
+//======================================================================
+namespace
+{
+    template <typename ResultType>
+    bool rand_range__test_bounds(ResultType const a, ResultType const b)
+    {
+        // Integral values fall on [a, b]; floating-point values on [a, b).
+        // Enough values are drawn to cross several block refills.
+        tbx::rand_range<ResultType> r(a, b);
+        std::vector<ResultType> v(1'000u);
+        std::copy_n(r.begin(), v.size(), v.begin());
+        auto pass{ true };
+        for (auto const x : v)
+            pass = !(x < a) && (std::is_floating_point_v<ResultType> ? x < b : !(b < x)) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_range__test_bounds()
+    {
+        auto pass{ true };
+        pass = ::rand_range__test_bounds<int>(-5, 5) && pass;
+        pass = ::rand_range__test_bounds<int>(7, 7) && pass;
+        pass = ::rand_range__test_bounds<unsigned>(0u, std::numeric_limits<unsigned>::max()) && pass;
+        pass = ::rand_range__test_bounds<long long>(
+            std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max()) && pass;
+        pass = ::rand_range__test_bounds<long long>(-1, 1'000'000'000'000) && pass;
+        pass = ::rand_range__test_bounds<unsigned char>(10u, 20u) && pass;
+        pass = ::rand_range__test_bounds<bool>(false, true) && pass;
+        pass = ::rand_range__test_bounds<char>('a', 'z') && pass;
+        pass = ::rand_range__test_bounds<double>(-1.0, 1.0) && pass;
+        pass = ::rand_range__test_bounds<float>(1.0f, 1.0000002f) && pass;
+        pass = ::rand_range__test_bounds<long double>(0.0L, 1.0L) && pass;
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_range__test_uniformity()
+    {
+        // Each face of a die should come up about n_rolls / 6 times.
+        // The tolerance is about eight standard deviations.
+        enum : int { n_rolls = 60'000 };
+        std::array<int, 7> count{};
+        tbx::rand_range<int> die(1, 6);
+        auto it{ die.begin() };
+        for (int i{ n_rolls }; i--;)
+            ++count[*it++];
+        auto const expected{ n_rolls / 6.0 };
+        auto const tolerance{ 8.0 * std::sqrt(expected * 5.0 / 6.0) };
+        auto pass{ count[0] == 0 };
+        for (int face{ 1 }; face <= 6; ++face)
+            pass = std::abs(count[face] - expected) < tolerance && pass;
+        double sum{};
+        tbx::rand_range<double> u;
+        auto uit{ u.begin() };
+        for (int i{ n_rolls }; i--; ++uit)
+            sum += *uit;
+        pass = std::abs(sum / n_rolls - 0.5) < 0.01 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_range__test_srand()
+    {
+        // After identical calls to srand(), two ranges built in turn
+        // deliver the same values.
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        std::vector<int> v1(600u), v2(600u);
+        tbx::srand<int>(arbitrary_seed);
+        {
+            tbx::rand_range<int> r(0, 999);
+            std::copy_n(r.begin(), v1.size(), v1.begin());
+        }
+        tbx::srand<int>(arbitrary_seed);
+        {
+            tbx::rand_range<int> r(tbx::param_type<int>(0, 999));
+            std::copy_n(r.begin(), v2.size(), v2.begin());
+        }
+        auto pass{ v1 == v2 };
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_range__test_transform()
+    {
+        std::vector<int> v(500u);
+        std::iota(v.begin(), v.end(), 0);
+        tbx::rand_range<int> r(0, 1);
+        std::transform(v.begin(), v.end(), r.begin(), v.begin(),
+            [](int const x, int const coin) { return 2 * x + coin; });
+        auto pass{ true };
+        for (int i{}; i < static_cast<int>(v.size()); ++i)
+            pass = (v[i] == 2 * i || v[i] == 2 * i + 1) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_range__test_invalid_argument()
+    {
+        auto pass{ true };
+        try
+        {
+            tbx::rand_range<double> r(1.0, 1.0);
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        try
+        {
+            tbx::rand_range<char> r(tbx::param_type<char>(0, 1'000));
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_range
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_rand_range(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_range__test_bounds           () && pass;
+        pass = ::rand_range__test_uniformity       () && pass;
+        pass = ::rand_range__test_srand            () && pass;
+        pass = ::rand_range__test_transform        () && pass;
+        pass = ::rand_range__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_range \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - rand_string
+//======================================================================
+namespace
+{
+    bool rand_string__test_charset(tbx::charset const& cs)
+    {
+        // Every character must come from the charset, and every
+        // character of the charset should appear about n / size()
+        // times. The tolerance is about eight standard deviations. The
+        // odd lengths exercise the tail ends of each algorithm.
+        auto pass{ true };
+        std::string const chars(cs.data(), cs.size());
+        for (std::size_t const len : { 0u, 1u, 31u, 33u, 255u })
+        {
+            auto const s{ tbx::rand_string(len, cs) };
+            pass = s.size() == len && pass;
+            pass = s.find_first_not_of(chars) == std::string::npos && pass;
+        }
+        enum : std::size_t { n = 200'000u };
+        std::vector<char> v(n);
+        auto const end{ tbx::rand_string(v.data(), v.size(), cs) };
+        pass = end == v.data() + v.size() && pass;
+        std::array<int, 256> count{};
+        for (auto const c : v)
+            ++count[static_cast<unsigned char>(c)];
+        auto const p{ 1.0 / cs.size() };
+        auto const expected{ n * p };
+        auto const tolerance{ 8.0 * std::sqrt(expected * (1.0 - p)) + 1.0 };
+        for (std::size_t i{}; i < cs.size(); ++i)
+            pass = std::abs(count[static_cast<unsigned char>(cs[i])] - expected) < tolerance && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_string__test_charset()
+    {
+        auto pass{ true };
+        pass = ::rand_string__test_charset(tbx::charsets::hex) && pass;
+        pass = ::rand_string__test_charset(tbx::charsets::base32) && pass;
+        pass = ::rand_string__test_charset(tbx::charsets::base62) && pass;
+        pass = ::rand_string__test_charset(tbx::charsets::base64url) && pass;
+        pass = ::rand_string__test_charset(tbx::charsets::printable_ascii) && pass;
+        pass = ::rand_string__test_charset(tbx::charset{ "x" }) && pass;
+        pass = ::rand_string__test_charset(tbx::charset{ "abc" }) && pass;
+        pass = tbx::charsets::base62.size() == 62u && pass;
+        pass = tbx::charsets::printable_ascii.size() == 94u && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_string__test_srand()
+    {
+        // rand_string<ResultType> uses the engine seeded by srand<ResultType>.
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        tbx::srand<unsigned char>(arbitrary_seed);
+        auto const s1{ tbx::rand_string<unsigned char>(100u, tbx::charsets::hex) };
+        auto const s2{ tbx::rand_string<unsigned char>(100u, tbx::charsets::base62) };
+        tbx::srand<unsigned char>(arbitrary_seed);
+        auto pass{ s1 == tbx::rand_string<unsigned char>(100u, tbx::charsets::hex) };
+        pass = s2 == tbx::rand_string<unsigned char>(100u, tbx::charsets::base62) && pass;
+        std::string s3;
+        tbx::srand<unsigned char>(arbitrary_seed);
+        tbx::rand_string<unsigned char>(std::back_inserter(s3), 100u, tbx::charsets::hex);
+        pass = s1 == s3 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_string__test_invalid_argument()
+    {
+        auto pass{ true };
+        try
+        {
+            tbx::charset const cs{ "" };
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_string
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_rand_string(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_string__test_charset          () && pass;
+        pass = ::rand_string__test_srand            () && pass;
+        pass = ::rand_string__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_string \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - constexpr_rand
+//======================================================================
+namespace
+{
+    // These tables are computed by the compiler.
+    constexpr auto ct_dice{ tbx::constexpr_rand_array<int, 600>(42u, 1, 6) };
+    constexpr auto ct_words{ tbx::constexpr_rand_array<std::uint64_t, 3>(0u) };
+    constexpr auto ct_unit{ tbx::constexpr_rand_array<double, 100>(7u) };
+    constexpr auto ct_jitter{ tbx::constexpr_rand_array<float, 100>(7u, 0.5f, -0.5f) };
+    constexpr auto ct_bytes{ tbx::constexpr_rand_array<unsigned char, 100>(9u, 'a', 'z') };
+
+    template <typename T, std::size_t N>
+    constexpr bool all_in_range(std::array<T, N> const& a, T const lo, T const hi, bool const half_open)
+    {
+        for (auto const x : a)
+            if (x < lo || hi < x || (half_open && !(x < hi)))
+                return false;
+        return true;
+    }
+    static_assert(::all_in_range(ct_dice, 1, 6, false), "");
+    static_assert(::all_in_range(ct_unit, 0.0, 1.0, true), "");
+    static_assert(::all_in_range(ct_jitter, -0.5f, 0.5f, true), "");
+    static_assert(::all_in_range(ct_bytes, std::uint8_t{ 'a' }, std::uint8_t{ 'z' }, false), "");
+    //------------------------------------------------------------------
+    bool constexpr_rand__test_splitmix64()
+    {
+        // Reference values: SplitMix64, seeded with 0
+        auto pass{ ct_words[0] == 0xe220'a839'7b1d'cdafu };
+        pass = ct_words[1] == 0x6e78'9e6a'a1b9'65f4u && pass;
+        pass = ct_words[2] == 0x06c4'5d18'8009'454fu && pass;
+        tbx::splitmix64 g1{ 0u }, g2{ 0u };
+        g1.discard(2u);
+        g2();
+        g2();
+        pass = g1 == g2 && g1() == ct_words[2] && pass;
+        std::uniform_int_distribution<int> d(1, 6);
+        auto const x{ d(g1) };
+        pass = 1 <= x && x <= 6 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool constexpr_rand__test_runtime()
+    {
+        // The same computation, run at run time, gives the same table.
+        auto const rt_dice{ tbx::constexpr_rand_array<int, 600>(42u, 1, 6) };
+        auto pass{ rt_dice == ct_dice };
+        std::array<int, 7> count{};
+        for (auto const x : ct_dice)
+            ++count[x];
+        for (int face{ 1 }; face <= 6; ++face)
+            pass = 50 < count[face] && count[face] < 150 && pass;
+        tbx::splitmix64 g{ ::make_arbitrary_seed() };
+        auto const big{ tbx::constexpr_rand(g, std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max()) };
+        pass = tbx::constexpr_rand(g, big, big) == big && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool constexpr_rand__test_invalid_argument()
+    {
+        auto pass{ false };
+        try
+        {
+            tbx::splitmix64 g;
+            tbx::constexpr_rand(g, 1.0, 1.0);
+        }
+        catch (std::invalid_argument const&)
+        {
+            pass = true;
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - constexpr_rand
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_constexpr_rand(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::constexpr_rand__test_splitmix64       () && pass;
+        pass = ::constexpr_rand__test_runtime          () && pass;
+        pass = ::constexpr_rand__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::constexpr_rand \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - rand_counts
+//======================================================================
+namespace
+{
+    bool rand_counts__test_binomial(std::uint64_t const n, double const p)
+    {
+        // With two outcomes, the first count is binomial(n, p). The mean
+        // and variance of many samples are checked against n p and
+        // n p (1 - p). The tolerances are about eight standard errors.
+        enum : int { n_samples = 20'000 };
+        double sum{}, sum_sq{};
+        for (int i{ n_samples }; i--;)
+        {
+            auto const counts{ tbx::rand_counts(n, { p, 1.0 - p }) };
+            auto const x{ static_cast<double>(counts[0]) };
+            sum += x;
+            sum_sq += x * x;
+        }
+        auto const mean{ sum / n_samples };
+        auto const variance{ sum_sq / n_samples - mean * mean };
+        auto const expected_mean{ n * p };
+        auto const expected_variance{ n * p * (1.0 - p) };
+        auto pass{ std::abs(mean - expected_mean) < 8.0 * std::sqrt(expected_variance / n_samples) + 1e-9 };
+        pass = std::abs(variance - expected_variance) < 0.1 * expected_variance + 1e-9 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_counts__test_binomial()
+    {
+        auto pass{ true };
+        pass = ::rand_counts__test_binomial(20u, 0.1) && pass;          // inversion
+        pass = ::rand_counts__test_binomial(20u, 0.9) && pass;          // inversion, reflected
+        pass = ::rand_counts__test_binomial(1'000u, 0.3) && pass;       // BTRD
+        pass = ::rand_counts__test_binomial(1'000u, 0.75) && pass;      // BTRD, reflected
+        pass = ::rand_counts__test_binomial(100'000u, 0.5) && pass;     // BTRD
+        pass = ::rand_counts__test_binomial(1'000'000u, 1e-5) && pass;  // inversion, large n
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_counts__test_uniform()
+    {
+        // The counts always total n. Ten billion dice rolls take no
+        // longer than ten.
+        auto const n{ std::uint64_t{ 10'000'000'000u } };
+        auto const counts{ tbx::rand_counts(n, 1, 6) };
+        auto pass{ counts.size() == 6u };
+        std::uint64_t total{};
+        auto const expected{ n / 6.0 };
+        for (auto const c : counts)
+        {
+            total += c;
+            pass = std::abs(c - expected) < 8.0 * std::sqrt(expected) && pass;
+        }
+        pass = total == n && pass;
+        auto const coins{ tbx::rand_counts<bool>(10u, true, false) };
+        pass = coins.size() == 2u && coins[0] + coins[1] == 10u && pass;
+        pass = tbx::rand_counts(0u, -3, 3) == std::vector<std::uint64_t>(7u) && pass;
+        pass = tbx::rand_counts(5u, 'x', 'x') == std::vector<std::uint64_t>{ 5u } && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_counts__test_weighted()
+    {
+        auto const n{ std::uint64_t{ 1'000'000u } };
+        std::vector<double> const weights{ 1.0, 0.0, 2.0, 7.0, 0.0 };
+        auto const counts{ tbx::rand_counts(n, weights.begin(), weights.end()) };
+        auto pass{ counts.size() == weights.size() };
+        pass = counts[1] == 0u && counts[4] == 0u && pass;
+        pass = counts[0] + counts[2] + counts[3] == n && pass;
+        for (std::size_t i{}; i < weights.size(); ++i)
+        {
+            auto const expected{ n * weights[i] / 10.0 };
+            pass = std::abs(counts[i] - expected) < 8.0 * std::sqrt(expected) + 1.0 && pass;
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_counts__test_invalid_argument()
+    {
+        auto pass{ true };
+        for (auto const& weights : { std::vector<double>{}, { 1.0, -1.0 }, { 0.0, 0.0 } })
+        {
+            try
+            {
+                tbx::rand_counts(10u, weights.begin(), weights.end());
+                pass = false;
+            }
+            catch (std::invalid_argument const&) {}
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_counts
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_rand_counts(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_counts__test_binomial         () && pass;
+        pass = ::rand_counts__test_uniform          () && pass;
+        pass = ::rand_counts__test_weighted         () && pass;
+        pass = ::rand_counts__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_counts \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - rand_poisson, rand_binomial, rand_gamma
+//======================================================================
+namespace
+{
+    // The mean and variance of many samples are checked against their
+    // expected values. The tolerance for the mean is about eight
+    // standard errors; for the variance, a generous ten percent.
+    template <typename Sampler>
+    bool check_moments(Sampler sampler, double const expected_mean, double const expected_variance)
+    {
+        enum : int { n_samples = 200'000 };
+        double sum{}, sum_sq{};
+        for (int i{ n_samples }; i--;)
+        {
+            auto const x{ static_cast<double>(sampler()) };
+            sum += x;
+            sum_sq += x * x;
+        }
+        auto const mean{ sum / n_samples };
+        auto const variance{ sum_sq / n_samples - mean * mean };
+        auto pass{ std::abs(mean - expected_mean) < 8.0 * std::sqrt(expected_variance / n_samples) + 1e-12 };
+        pass = std::abs(variance - expected_variance) < 0.1 * expected_variance + 1e-12 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_poisson__test_moments()
+    {
+        auto pass{ true };
+        for (auto const mean : { 0.0, 0.5, 4.0, 9.99, 10.0, 37.5, 1e6 })
+        {
+            tbx::poisson_param const p{ mean };
+            pass = ::check_moments([&p] { return tbx::rand_poisson<long long>(p); }, mean, mean) && pass;
+        }
+        pass = ::check_moments([] { return tbx::rand_poisson(3.0); }, 3.0, 3.0) && pass;
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_binomial__test_moments()
+    {
+        auto pass{ true };
+        for (auto const& np : { std::make_pair(1u, 0.5), { 20u, 0.2 }, { 500u, 0.7 }, { 5'000'000u, 0.01 } })
+        {
+            tbx::binomial_param const p{ np.first, np.second };
+            auto const mean{ np.first * np.second };
+            pass = ::check_moments([&p] { return tbx::rand_binomial(p); }, mean, mean * (1.0 - np.second)) && pass;
+        }
+        pass = tbx::rand_binomial(7u, 1.0) == 7 && tbx::rand_binomial(7u, 0.0) == 0 && pass;
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_gamma__test_moments()
+    {
+        auto pass{ true };
+        for (auto const& ab : { std::make_pair(0.3, 1.0), { 1.0, 2.0 }, { 2.5, 0.5 }, { 100.0, 3.0 } })
+        {
+            tbx::gamma_param const p{ ab.first, ab.second };
+            auto const mean{ ab.first * ab.second };
+            pass = ::check_moments([&p] { return tbx::rand_gamma(p); }, mean, mean * ab.second) && pass;
+        }
+        pass = ::check_moments([] { return tbx::rand_gamma<float>(4.0f); }, 4.0, 4.0) && pass;
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_poisson__test_srand()
+    {
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        std::vector<unsigned> v1, v2;
+        std::vector<double> g1, g2;
+        tbx::srand<unsigned>(arbitrary_seed);
+        tbx::srand<double>(arbitrary_seed);
+        for (int i{ 100 }; i--;)
+        {
+            v1.push_back(tbx::rand_poisson<unsigned>(25.0));
+            v1.push_back(tbx::rand_binomial<unsigned>(100u, 0.4));
+            g1.push_back(tbx::rand_gamma(1.5));
+        }
+        tbx::srand<unsigned>(arbitrary_seed);
+        tbx::srand<double>(arbitrary_seed);
+        for (int i{ 100 }; i--;)
+        {
+            v2.push_back(tbx::rand_poisson<unsigned>(tbx::poisson_param{ 25.0 }));
+            v2.push_back(tbx::rand_binomial<unsigned>(tbx::binomial_param{ 100u, 0.4 }));
+            g2.push_back(tbx::rand_gamma(tbx::gamma_param{ 1.5 }));
+        }
+        auto pass{ v1 == v2 && g1 == g2 };
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_poisson__test_invalid_argument()
+    {
+        auto pass{ true };
+        try
+        {
+            tbx::poisson_param const p{ -1.0 };
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        try
+        {
+            tbx::binomial_param const p{ 10u, 1.5 };
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        try
+        {
+            tbx::gamma_param const p{ 0.0 };
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        try
+        {
+            tbx::gamma_param const p{ 1.0, -2.0 };
+            pass = false;
+        }
+        catch (std::invalid_argument const&) {}
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_poisson, rand_binomial, rand_gamma
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_rand_poisson_binomial_gamma(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_poisson__test_moments          () && pass;
+        pass = ::rand_binomial__test_moments         () && pass;
+        pass = ::rand_gamma__test_moments            () && pass;
+        pass = ::rand_poisson__test_srand            () && pass;
+        pass = ::rand_poisson__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_poisson, tbx::rand_binomial, tbx::rand_gamma \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - monte_carlo_reduce
+//======================================================================
+namespace
+{
+    bool monte_carlo_reduce__test_pi()
+    {
+        // Estimate pi, by counting the points that fall inside the unit
+        // circle. The standard error is about 1.6 / sqrt(n).
+        auto const n{ std::uint64_t{ 4'000'000u } };
+        auto const hits{ tbx::monte_carlo_reduce(n, [](auto&) {
+            auto const x{ tbx::rand<double>() };
+            auto const y{ tbx::rand<double>() };
+            return std::uint64_t{ x * x + y * y < 1.0 };
+        }, std::plus<>{}, ::make_arbitrary_seed()) };
+        auto const pi{ 4.0 * hits / n };
+        auto pass{ std::abs(pi - 3.141592653589793) < 8.0 * 1.6 / std::sqrt(n) };
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool monte_carlo_reduce__test_thread_count()
+    {
+        // Floating-point sums, which depend on the order of addition, are
+        // identical for every thread count.
+        auto const n{ std::uint64_t{ 300'001u } };
+        auto const seed{ ::make_arbitrary_seed() };
+        auto kernel = [](auto& g) {
+            return std::generate_canonical<double, 53>(g);
+        };
+        auto const expected{ tbx::monte_carlo_reduce(n, kernel, std::plus<>{}, seed, 1u) };
+        auto pass{ std::abs(expected / n - 0.5) < 0.01 };
+        for (unsigned const n_threads : { 2u, 3u, 8u, 0u })
+            pass = tbx::monte_carlo_reduce(n, kernel, std::plus<>{}, seed, n_threads) == expected && pass;
+        pass = tbx::monte_carlo_reduce(n, kernel, std::plus<>{}, seed + 1u, 4u) != expected && pass;
+        auto const maximum{ tbx::monte_carlo_reduce(n, [](auto&) { return tbx::rand<int>(-100, -1); },
+            [](int const a, int const b) { return a < b ? b : a; }, seed) };
+        pass = maximum == -1 && pass;
+        pass = tbx::monte_carlo_reduce(0u, kernel, std::plus<>{}) == 0.0 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool monte_carlo_reduce__test_exception()
+    {
+        auto pass{ false };
+        try
+        {
+            std::atomic<int> calls{};
+            tbx::monte_carlo_reduce(100'000u, [&calls](auto&) {
+                if (++calls == 5'000)
+                    throw std::invalid_argument("kernel failed");
+                return 1;
+            }, std::plus<>{}, 1u, 4u);
+        }
+        catch (std::invalid_argument const&)
+        {
+            pass = true;
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - monte_carlo_reduce
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_monte_carlo_reduce(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::monte_carlo_reduce__test_pi           () && pass;
+        pass = ::monte_carlo_reduce__test_thread_count () && pass;
+        pass = ::monte_carlo_reduce__test_exception    () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::monte_carlo_reduce \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - task_rng
+//======================================================================
+namespace
+{
+    static_assert(sizeof(tbx::task_rng<double>) <= 32u, "");
+
+    template <typename ResultType>
+    std::vector<ResultType> task_rng__draw(std::uint64_t const root_seed, std::uint64_t const task_id)
+    {
+        tbx::task_rng<ResultType> rng(root_seed, task_id);
+        std::vector<ResultType> v;
+        for (int i{ 20 }; i--;)
+            v.push_back(rng.rand());
+        return v;
+    }
+    //------------------------------------------------------------------
+    bool task_rng__test_reproducible()
+    {
+        // The values depend on (root_seed, task_id), and not on the
+        // thread where the task runs.
+        auto const root_seed{ std::uint64_t{ ::make_arbitrary_seed() } };
+        std::vector<std::vector<unsigned>> by_thread(8u);
+        std::vector<std::thread> pool;
+        for (std::uint64_t task{}; task < by_thread.size(); ++task)
+            pool.emplace_back([&by_thread, root_seed, task] {
+                by_thread[task] = ::task_rng__draw<unsigned>(root_seed, task);
+            });
+        for (auto& t : pool)
+            t.join();
+        auto pass{ true };
+        for (std::uint64_t task{}; task < by_thread.size(); ++task)
+        {
+            pass = by_thread[task] == ::task_rng__draw<unsigned>(root_seed, task) && pass;
+            if (task)
+                pass = by_thread[task] != by_thread[task - 1u] && pass;
+        }
+        pass = ::task_rng__draw<double>(root_seed, 1u) != ::task_rng__draw<double>(root_seed + 1u, 1u) && pass;
+        tbx::task_rng rng(1u, 2u);
+        pass = std::is_same_v<decltype(rng.rand()), int> && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool task_rng__test_ranges()
+    {
+        tbx::task_rng<int> ri(42u, ::make_arbitrary_seed());
+        tbx::task_rng<double> rd(42u, ::make_arbitrary_seed());
+        tbx::task_rng<char> rc(42u, ::make_arbitrary_seed());
+        tbx::task_rng<bool> rb(42u, ::make_arbitrary_seed());
+        auto pass{ ri.rand_max() == std::numeric_limits<int>::max() && rd.rand_max() == 1.0 };
+        auto const pd{ tbx::param_type<double>(2.0, 3.0) };
+        auto const pc{ tbx::param_type<char>('a', 'f') };
+        int n_true{};
+        for (int i{ 1'000 }; i--;)
+        {
+            auto const x{ ri.rand() };
+            auto const y{ ri.rand(6, 1) };
+            auto const z{ rd.rand() };
+            auto const w{ rd.rand(pd) };
+            auto const c{ rc.rand(pc) };
+            n_true += rb.rand();
+            pass = 0 <= x && 1 <= y && y <= 6 && 0.0 <= z && z < 1.0 && 2.0 <= w && w < 3.0 && pass;
+            pass = 'a' <= c && c <= 'f' && pass;
+        }
+        pass = 400 < n_true && n_true < 600 && pass;
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - task_rng
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_task_rng(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::task_rng__test_reproducible () && pass;
+        pass = ::task_rng__test_ranges       () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::task_rng \n";
+        return pass;
+    }
+}
+#if defined(TBX_RAND_ENGINE_POOL)
+//======================================================================
+// Test Routines - engine_pool
+//======================================================================
+namespace
+{
+    bool engine_pool__test_recycling()
+    {
+        // Threads adopt parked engines, and park them again on exit.
+        using pool = tbx::engine_pool<short>;
+        pool::prewarm(8u);
+        auto const parked{ pool::size() };
+        auto pass{ parked >= 8u };
+        std::size_t parked_in_thread{};
+        std::thread t([&parked_in_thread] {
+            tbx::rand<short>();
+            parked_in_thread = pool::size();
+        });
+        t.join();
+        pass = parked_in_thread == parked - 1u && pool::size() == parked && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool engine_pool__test_reseed_on_adopt()
+    {
+        // With reseed_on_adopt, each thread starts as if srand(1u) had
+        // been called. Without it, a thread may pick up where another
+        // left off.
+        using pool = tbx::engine_pool<unsigned short>;
+        std::vector<unsigned short> v1, v2, v3;
+        auto draw = [](std::vector<unsigned short>& v) {
+            std::thread t([&v] {
+                for (int i{ 10 }; i--;)
+                    v.push_back(tbx::rand<unsigned short>());
+            });
+            t.join();
+        };
+        pool::reseed_on_adopt(true);
+        draw(v1);
+        draw(v2);
+        auto pass{ v1 == v2 };
+        tbx::rand_replacement<unsigned short> expected;
+        for (auto const x : v1)
+            pass = x == expected.rand() && pass;
+        pool::reseed_on_adopt(false);
+        draw(v3);
+        for (auto const x : v3)
+            pass = x == expected.rand() && pass;
+        pass = pool::reseed_on_adopt() == false && pass;
+        pool::reseed_on_adopt(true);
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - engine_pool
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_engine_pool(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::engine_pool__test_recycling       () && pass;
+        pass = ::engine_pool__test_reseed_on_adopt () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::engine_pool \n";
+        return pass;
+    }
+}
+#endif
+//======================================================================
+// Test Routines - fixed_seed_seq
+//======================================================================
+namespace
+{
+    template <std::size_t N>
+    bool fixed_seed_seq__test_param(std::vector<std::uint32_t> const& entropy)
+    {
+        // A seed sequence rebuilt from param() generates the same seeds.
+        tbx::fixed_seed_seq<N> const s1(entropy.begin(), entropy.end());
+        std::array<std::uint32_t, N> p{};
+        s1.param(p.begin());
+        tbx::fixed_seed_seq<N> const s2(p.begin(), p.end());
+        std::vector<std::uint32_t> v1(100u), v2(100u);
+        s1.generate(v1.begin(), v1.end());
+        s2.generate(v2.begin(), v2.end());
+        auto pass{ v1 == v2 && s1.size() == N };
+        if (entropy.size() == N)
+            pass = std::equal(p.begin(), p.end(), entropy.begin()) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool fixed_seed_seq__test_param()
+    {
+        auto pass{ true };
+        pass = ::fixed_seed_seq__test_param<1u>({ 42u }) && pass;
+        pass = ::fixed_seed_seq__test_param<4u>({ 1u, 2u, 3u, 4u }) && pass;
+        pass = ::fixed_seed_seq__test_param<4u>({ 1u, 2u }) && pass;
+        pass = ::fixed_seed_seq__test_param<4u>({ 1u, 2u, 3u, 4u, 5u, 6u, 7u }) && pass;
+        pass = ::fixed_seed_seq__test_param<8u>({ static_cast<std::uint32_t>(::make_arbitrary_seed()), 0xffff'ffffu, 0u, 7u, 7u, 7u, 7u, 7u }) && pass;
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool fixed_seed_seq__test_generate()
+    {
+        // Small changes in the entropy change every seed.
+        tbx::fixed_seed_seq<4u> const s1{ 1u, 2u, 3u }, s2{ 1u, 2u, 4u };
+        std::array<std::uint32_t, 64> v1{}, v2{};
+        s1.generate(v1.begin(), v1.end());
+        s2.generate(v2.begin(), v2.end());
+        auto pass{ true };
+        for (std::size_t i{}; i < v1.size(); ++i)
+            pass = v1[i] != v2[i] && pass;
+        std::array<std::uint64_t, 3> wide{};
+        s1.generate(wide.begin(), wide.end());
+        pass = wide[0] == v1[0] && wide[2] == v1[2] && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool fixed_seed_seq__test_srand()
+    {
+        // srand() accepts any seed sequence, and seeds the same state as
+        // the engine's own seed() function.
+        tbx::fixed_seed_seq<4u> sseq{ ::make_arbitrary_seed(), ::seed_type{ 99u } };
+        std::mt19937 eng(sseq);
+        std::uniform_int_distribution<int> dist;
+        tbx::srand<int>(sseq);
+        auto pass{ true };
+        for (int i{ 100 }; i--;)
+            pass = tbx::rand<int>() == dist(eng) && pass;
+        tbx::srand<char>(sseq);
+        auto const c1{ tbx::rand<char>() };
+        tbx::srand<char>(sseq);
+        pass = tbx::rand<char>() == c1 && pass;
+        tbx::seed_seq_rd rd;
+        tbx::srand<double>(rd);
+        std::seed_seq const std_sseq{ 1, 2, 3 };
+        tbx::srand<double>(std_sseq);
+        auto const d1{ tbx::rand<double>() };
+        std::seed_seq std_sseq2{ 1, 2, 3 };
+        tbx::srand<double>(std_sseq2);
+        pass = tbx::rand<double>() == d1 && pass;
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - fixed_seed_seq
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_fixed_seed_seq(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::fixed_seed_seq__test_param    () && pass;
+        pass = ::fixed_seed_seq__test_generate () && pass;
+        pass = ::fixed_seed_seq__test_srand    () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::fixed_seed_seq \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - mt19937
+//======================================================================
+namespace
+{
+    template <typename SeedSeq>
+    bool mt19937__test_same_output(SeedSeq& sseq_1, SeedSeq& sseq_2)
+    {
+        // Equal seed sequences, equal streams, including the redraws
+        // that cross twist boundaries.
+        tbx::mt19937 e1{ sseq_1 };
+        std::mt19937 e2{ sseq_2 };
+        auto pass{ true };
+        for (int i{ 2'000 }; i--;)
+            pass = e1() == e2() && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool mt19937__test_same_output()
+    {
+        auto pass{ true };
+        for (std::uint32_t const seed : { 0u, 1u, 5489u, 0xffff'ffffu, static_cast<std::uint32_t>(::make_arbitrary_seed()) })
+        {
+            tbx::mt19937 e1{ seed };
+            std::mt19937 e2{ seed };
+            e1.discard(1'000u);
+            e2.discard(1'000u);
+            for (int i{ 2'000 }; i--;)
+                pass = e1() == e2() && pass;
+        }
+        std::seed_seq s1{ 1, 3, 5, 7, 11, 13, 17, 19, 23, 29 }, s2{ 1, 3, 5, 7, 11, 13, 17, 19, 23, 29 };
+        pass = ::mt19937__test_same_output(s1, s2) && pass;
+        tbx::fixed_seed_seq<> f1{ 99u }, f2{ 99u };
+        pass = ::mt19937__test_same_output(f1, f2) && pass;
+
+        // The C++ standard requires the 10000th value of a default-
+        // constructed mt19937 to be 4123659995.
+        tbx::mt19937 e3;
+        e3.discard(9'999u);
+        pass = e3() == 4'123'659'995u && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool mt19937__test_equality()
+    {
+        tbx::mt19937 e1{ 42u }, e2;
+        auto pass{ e1 != e2 };
+        e2.seed(42u);
+        pass = e1 == e2 && pass;
+        e1();
+        pass = e1 != e2 && pass;
+        e2();
+        pass = e1 == e2 && pass;
+        auto e3{ e1 };  // a copy, even though e1 is not const
+        pass = e1 == e3 && pass;
+        pass = sizeof(tbx::mt19937) < sizeof(std::uint32_t) * 625u + sizeof(std::size_t) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool mt19937__test_srand()
+    {
+        // Whichever engine rand_replacement uses, each overload of srand
+        // produces the stream that std::mt19937 would.
+        auto pass{ true };
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        tbx::srand<unsigned>(arbitrary_seed);
+        std::mt19937 e1{ static_cast<std::mt19937::result_type>(arbitrary_seed) };
+        for (int i{ 100 }; i--;)
+            pass = tbx::rand<unsigned>(0u, 0xffff'ffffu) == e1() && pass;
+        std::seed_seq const s1{ 2, 4, 6 };
+        std::seed_seq s2{ 2, 4, 6 };
+        tbx::srand<unsigned>(s1);
+        std::mt19937 e2{ s2 };
+        for (int i{ 100 }; i--;)
+            pass = tbx::rand<unsigned>(0u, 0xffff'ffffu) == e2() && pass;
+        tbx::srand<unsigned>(std::mt19937::default_seed);
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool mt19937__test_constexpr()
+    {
+        // Seeding by value works at compile time. Seed 1u, which is
+        // copied from a precomputed state, and other seeds, which are
+        // computed, give the streams of std::mt19937.
+        constexpr tbx::mt19937 e1{ 1u };
+        constexpr tbx::mt19937 e2{ 42u };
+        constexpr tbx::mt19937 e3;
+        auto pass{ true };
+        for (auto e : { std::pair{ e1, std::mt19937{ 1u } }, { e2, std::mt19937{ 42u } }, { e3, std::mt19937{} } })
+        {
+            for (int i{ 1'000 }; i--;)
+                pass = e.first() == e.second() && pass;
+        }
+        tbx::mt19937 e4{ 42u };
+        e4.seed(1u);
+        pass = e4 == e1 && pass;
+#if defined(TBX_RAND_COMPACT_MT19937) && !defined(TBX_RAND_TAPE) && !defined(TBX_RAND_SHADOW)
+        // The engines of rr() can be constant-initialized.
+        constexpr tbx::rand_replacement<int> r1;
+        constexpr tbx::rand_replacement<char> r2;
+        auto c1{ r1 };
+        auto c2{ r2 };
+        tbx::rand_replacement<int> r3;
+        tbx::rand_replacement<char> r4;
+        for (int i{ 1'000 }; i--;)
+        {
+            pass = c1.rand() == r3.rand() && pass;
+            pass = c2.rand() == r4.rand() && pass;
+        }
+#endif
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - mt19937
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_mt19937(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::mt19937__test_same_output () && pass;
+        pass = ::mt19937__test_equality    () && pass;
+        pass = ::mt19937__test_srand       () && pass;
+        pass = ::mt19937__test_constexpr   () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::mt19937 \n";
+        return pass;
+    }
+}
+
+//======================================================================
+// Test Routines - rand_bounded_batch
+//======================================================================
+namespace
+{
+    template <typename T>
+    bool rand_bounded_batch__test_range(std::vector<T> const& bounds)
+    {
+        std::vector<T> v(bounds.size());
+        auto const last{ tbx::rand_bounded_batch(bounds.begin(), v.begin(), bounds.size()) };
+        auto pass{ last == v.end() };
+        for (std::size_t i{}; i < v.size(); ++i)
+            pass = T{ 0 } <= v[i] && v[i] < bounds[i] && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_bounded_batch__test_range()
+    {
+        // The lengths straddle the block size, and the AVX2 lane count.
+        auto pass{ true };
+        for (std::size_t const n : { 1u, 7u, 8u, 9u, 255u, 256u, 257u, 1'000u })
+        {
+            std::vector<int> a(n);
+            std::vector<unsigned> b(n);
+            std::vector<std::uint64_t> c(n);
+            std::vector<double> d(n);
+            std::vector<float> e(n);
+            for (std::size_t i{}; i < n; ++i)
+            {
+                a[i] = static_cast<int>(i % 13u) + 1;
+                b[i] = i % 2u ? 0x8000'0001u : 0xffff'ffffu - static_cast<unsigned>(i);
+                c[i] = i % 3u ? (std::uint64_t{ 1u } << 40) + i : i + 1u;
+                d[i] = 0.5 + static_cast<double>(i);
+                e[i] = i % 2u ? 1e-30f : 3.0f;
+            }
+            pass = ::rand_bounded_batch__test_range(a) && pass;
+            pass = ::rand_bounded_batch__test_range(b) && pass;
+            pass = ::rand_bounded_batch__test_range(c) && pass;
+            pass = ::rand_bounded_batch__test_range(d) && pass;
+            pass = ::rand_bounded_batch__test_range(e) && pass;
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_bounded_batch__test_uniformity()
+    {
+        // Per-element dice, with 2 to 7 faces. Each face should come up
+        // about n_rolls / faces times. The tolerance is about eight
+        // standard deviations.
+        enum : int { n_rolls = 60'000, n_dice = 6 };
+        std::vector<short> faces(n_rolls * n_dice), rolls(faces.size());
+        for (std::size_t i{}; i < faces.size(); ++i)
+            faces[i] = static_cast<short>(i % n_dice + 2u);
+        tbx::rand_bounded_batch(faces.begin(), rolls.begin(), faces.size());
+        std::array<std::array<int, n_dice + 1>, n_dice> count{};
+        for (std::size_t i{}; i < rolls.size(); ++i)
+            ++count[i % n_dice][rolls[i]];
+        auto pass{ true };
+        for (int j{}; j < n_dice; ++j)
+        {
+            auto const p{ 1.0 / (j + 2) };
+            auto const expected{ n_rolls * p };
+            auto const tolerance{ 8.0 * std::sqrt(expected * (1.0 - p)) };
+            for (int k{}; k < j + 2; ++k)
+                pass = std::abs(count[j][k] - expected) < tolerance && pass;
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_bounded_batch__test_iterators()
+    {
+        // Any input range of bounds, and any output iterator.
+        std::list<long> const bounds{ 1, 1, 1, 2, 1 };
+        std::vector<long> v;
+        tbx::rand_bounded_batch(bounds.begin(), std::back_inserter(v), bounds.size());
+        auto pass{ v.size() == 5u && v[0] == 0 && v[1] == 0 && v[2] == 0 && v[4] == 0 && v[3] < 2 };
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_bounded_batch__test_invalid_argument()
+    {
+        auto throws = [](auto&& f)
+        {
+            try
+            {
+                f();
+            }
+            catch (std::invalid_argument const&)
+            {
+                return true;
+            }
+            return false;
+        };
+        auto pass{ true };
+        std::array<int, 3> const a{ 5, 0, 5 };
+        std::array<double, 2> const b{ 1.0, -1.0 };
+        std::array<double, 1> const c{ std::numeric_limits<double>::infinity() };
+        std::array<int, 3> x{};
+        std::array<double, 2> y{};
+        pass = throws([&] { tbx::rand_bounded_batch(a.begin(), x.begin(), a.size()); }) && pass;
+        pass = throws([&] { tbx::rand_bounded_batch(b.begin(), y.begin(), b.size()); }) && pass;
+        pass = throws([&] { tbx::rand_bounded_batch(c.begin(), y.begin(), c.size()); }) && pass;
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_bounded_batch
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_rand_bounded_batch(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_bounded_batch__test_range            () && pass;
+        pass = ::rand_bounded_batch__test_uniformity       () && pass;
+        pass = ::rand_bounded_batch__test_iterators        () && pass;
+        pass = ::rand_bounded_batch__test_invalid_argument () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_bounded_batch \n";
+        return pass;
+    }
+}
+
+//======================================================================
+// Test Routines - return types
+//======================================================================
+namespace
+{
+    template <typename ResultType>
+    bool return_types__test()
+    {
+        // tbx.rand.fwd.h declares the rand() family with explicit return
+        // types, so that callers need not see the definitions.
+        using p = tbx::param_type<ResultType>;
+        static_assert(std::is_same_v<decltype(tbx::rand<ResultType>()), ResultType>, "");
+        static_assert(std::is_same_v<decltype(tbx::rand<ResultType>(ResultType{}, ResultType{})), ResultType>, "");
+        static_assert(std::is_same_v<decltype(tbx::rand<ResultType>(std::declval<p>())), ResultType>, "");
+        static_assert(std::is_same_v<decltype(tbx::rand_max<ResultType>()), ResultType>, "");
+        static_assert(std::is_same_v<decltype(tbx::rr<ResultType>()), tbx::rand_replacement<ResultType>&>, "");
+        return true;
+    }
+}
+//======================================================================
+// Driver Routine - return types
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_return_types(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::return_types__test<bool>          () && pass;
+        pass = ::return_types__test<char>          () && pass;
+        pass = ::return_types__test<short>         () && pass;
+        pass = ::return_types__test<int>           () && pass;
+        pass = ::return_types__test<std::uint64_t> () && pass;
+        pass = ::return_types__test<float>         () && pass;
+        pass = ::return_types__test<long double>   () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "explicit return types \n";
+        return pass;
+    }
+}
+
+//======================================================================
+// Test Routines - qrand
+//======================================================================
+namespace
+{
+    bool qrand__test_reference_values()
+    {
+        // Point 999, as generated by SciPy 1.17 (scipy.stats.qmc),
+        // which also uses the direction numbers of Joe and Kuo.
+        tbx::sobol<double, 64u> s;
+        s.seek(999u);
+        auto const p{ s.rand() };
+        auto pass{ p[0] == 675'282'944 * 0x1p-32 };
+        pass = p[1] == 3'904'897'024 * 0x1p-32 && pass;
+        pass = p[2] == 348'127'232 * 0x1p-32 && pass;
+        pass = p[61] == 2'856'321'024 * 0x1p-32 && pass;
+        pass = p[62] == 2'453'667'840 * 0x1p-32 && pass;
+        pass = p[63] == 2'722'103'296 * 0x1p-32 && pass;
+        tbx::halton<double, 64u> h;
+        h.seek(499u);
+        auto const q{ h.rand() };
+        pass = q[0] == 0.810546875 && pass;
+        pass = std::abs(q[1] - 0.48422496570644719) < 1e-15 && pass;
+        pass = std::abs(q[63] - 0.60451194673338771) < 1e-15 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    template <typename Q>
+    bool qrand__test_seek(Q q)
+    {
+        // seek(i), generate(), and repeated calls to rand() all agree.
+        std::vector<typename Q::result_type> v(1'000u);
+        auto const first{ q.index() };
+        q.generate(v.begin(), v.size());
+        auto pass{ q.index() == first + v.size() };
+        for (std::size_t const i : { 0u, 1u, 2u, 3u, 255u, 256u, 511u, 999u })
+        {
+            q.seek(first + i);
+            pass = q.rand() == v[i] && pass;
+        }
+        q.seek(first + 100u);
+        q.discard(200u);
+        pass = q.rand() == v[300] && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    template <typename Q>
+    bool qrand__test_stratification(Q q, std::size_t const n_dims)
+    {
+        // Each of the first 2^12 points falls in a different interval
+        // [j / 2^12, (j + 1) / 2^12), in every dimension of a Sobol
+        // sequence, and in the base-2 dimension of a Halton sequence,
+        // with or without scrambling.
+        enum : std::size_t { n = 4'096u };
+        std::vector<std::vector<bool>> seen(n_dims, std::vector<bool>(n));
+        auto pass{ true };
+        for (std::size_t i{}; i < n; ++i)
+        {
+            auto const p{ q.rand() };
+            for (std::size_t d{}; d < n_dims; ++d)
+            {
+                auto const j{ static_cast<std::size_t>(p[d] * n) };
+                pass = j < n && !seen[d][j] && pass;
+                if (j < n)
+                    seen[d][j] = true;
+            }
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool qrand__test_net()
+    {
+        // The first 2^10 Sobol points in dimensions 1 and 2 form a
+        // (0, 10, 2)-net: every box of size 2^-i by 2^-(10 - i) holds
+        // exactly one point. Owen scrambling preserves that.
+        enum : std::size_t { m = 10u, n = std::size_t{ 1u } << m };
+        auto pass{ true };
+        for (auto const scrambled : { false, true })
+        {
+            tbx::sobol<double, 2u> s;
+            if (scrambled)
+                s.srand(static_cast<tbx::sobol<double, 2u>::seed_type>(::make_arbitrary_seed()));
+            std::vector<std::array<double, 2u>> v(n);
+            s.generate(v.begin(), n);
+            for (std::size_t i{}; i <= m; ++i)
+            {
+                std::vector<int> count(n);
+                for (auto const& p : v)
+                {
+                    auto const x{ static_cast<std::size_t>(std::ldexp(p[0], static_cast<int>(i))) };
+                    auto const y{ static_cast<std::size_t>(std::ldexp(p[1], static_cast<int>(m - i))) };
+                    ++count[(x << (m - i)) | y];
+                }
+                pass = std::all_of(count.begin(), count.end(), [](int const c) { return c == 1; }) && pass;
+            }
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool qrand__test_srand()
+    {
+        auto const arbitrary_seed{ static_cast<tbx::sobol<>::seed_type>(::make_arbitrary_seed()) };
+        tbx::sobol<float, 5u> s1{ arbitrary_seed }, s2, s3;
+        s2.srand(arbitrary_seed);
+        s3.srand(arbitrary_seed + 1u);
+        tbx::halton<double, 3u> h1, h2;
+        std::seed_seq sseq{ 1, 2, 3 };
+        h1.srand(sseq);
+        tbx::fixed_seed_seq<> f{ 1u, 2u, 3u };
+        h2.srand(f);
+        auto pass{ true };
+        for (int i{ 100 }; i--;)
+        {
+            auto const p{ s1.rand() };
+            pass = p == s2.rand() && p != s3.rand() && pass;
+            pass = h1.rand() != h2.rand() && pass;
+        }
+        tbx::sobol<double, 3u> s4;
+        s4.srand();
+        pass = s4.index() == 0u && s4.rand() != tbx::sobol<double, 3u>{}.rand() && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool qrand__test_range()
+    {
+        tbx::halton<double, 4u> h{ 5u };
+        tbx::sobol<float, 4u> s{ 5u };
+        auto pass{ true };
+        for (int i{ 1'000 }; i--;)
+        {
+            for (auto const x : h.rand(10.0, -10.0))
+                pass = -10.0 <= x && x < 10.0 && pass;
+            for (auto const x : s.rand(tbx::param_type<float>{ 1.0f, 2.0f }))
+                pass = 1.0f <= x && x < 2.0f && pass;
+        }
+        try
+        {
+            h.rand(1.0, 1.0);
+            pass = false;
+        }
+        catch (std::invalid_argument const&)
+        {
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - qrand
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_qrand(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::qrand__test_reference_values () && pass;
+        pass = ::qrand__test_seek(tbx::sobol<double, 7u>{}) && pass;
+        pass = ::qrand__test_seek(tbx::sobol<float, 64u>{ 3u }) && pass;
+        pass = ::qrand__test_seek(tbx::halton<double, 7u>{}) && pass;
+        pass = ::qrand__test_seek(tbx::halton<long double, 2u>{ 3u }) && pass;
+        pass = ::qrand__test_stratification(tbx::sobol<double, 20u>{}, 20u) && pass;
+        pass = ::qrand__test_stratification(tbx::sobol<double, 20u>{ 9u }, 20u) && pass;
+        pass = ::qrand__test_stratification(tbx::halton<double, 3u>{}, 1u) && pass;
+        pass = ::qrand__test_stratification(tbx::halton<double, 3u>{ 9u }, 1u) && pass;
+        pass = ::qrand__test_net   () && pass;
+        pass = ::qrand__test_srand () && pass;
+        pass = ::qrand__test_range () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::qrand \n";
+        return pass;
+    }
+}
+
+//======================================================================
+// Test Routines - geometric sampling
+//======================================================================
+namespace
+{
+    template <typename RealType, std::size_t N>
+    RealType geometric__norm(std::array<RealType, N> const& v)
+    {
+        RealType norm2{};
+        for (auto const x : v)
+            norm2 += x * x;
+        return std::sqrt(norm2);
+    }
+    //------------------------------------------------------------------
+    template <std::size_t N>
+    bool geometric__test_unit_vector()
+    {
+        // Unit length, and, by symmetry, E[x_i] = 0 and E[x_i^2] = 1 / N.
+        // The tolerances are about eight standard deviations.
+        enum : int { n = 20'000 };
+        std::array<double, N> mean{}, mean_square{};
+        auto pass{ true };
+        for (int i{ n }; i--;)
+        {
+            auto const v{ tbx::rand_unit_vector<N>() };
+            pass = std::abs(::geometric__norm(v) - 1.0) < 1e-12 && pass;
+            for (std::size_t j{}; j < N; ++j)
+            {
+                mean[j] += v[j] / n;
+                mean_square[j] += v[j] * v[j] / n;
+            }
+        }
+        for (std::size_t j{}; j < N; ++j)
+        {
+            pass = std::abs(mean[j]) < 8.0 / std::sqrt(n * static_cast<double>(N)) && pass;
+            pass = std::abs(mean_square[j] - 1.0 / N) < 8.0 / std::sqrt(n * static_cast<double>(N * N)) && pass;
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool geometric__test_disk_ball_sphere()
+    {
+        // A point in a disk lands in the inner half-radius a quarter of
+        // the time; a point in a ball, one time in eight.
+        enum : int { n = 40'000 };
+        int inner_disk{}, inner_ball{};
+        auto pass{ true };
+        for (int i{ n }; i--;)
+        {
+            auto const d{ ::geometric__norm(tbx::rand_in_disk(2.0)) };
+            auto const b{ ::geometric__norm(tbx::rand_in_ball(2.0f)) };
+            auto const s{ ::geometric__norm(tbx::rand_on_sphere(2.0)) };
+            pass = d <= 2.0 && b <= 2.0f * (1.0f + 1e-6f) && std::abs(s - 2.0) < 1e-12 && pass;
+            inner_disk += d < 1.0;
+            inner_ball += b < 1.0f;
+        }
+        pass = std::abs(inner_disk - n / 4.0) < 8.0 * std::sqrt(n * 0.25 * 0.75) && pass;
+        pass = std::abs(inner_ball - n / 8.0) < 8.0 * std::sqrt(n * 0.125 * 0.875) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool geometric__test_quaternion()
+    {
+        // For a uniformly random rotation, each component of the unit
+        // quaternion has E[q_i^2] = 1/4.
+        enum : int { n = 20'000 };
+        std::array<double, 4u> mean_square{};
+        auto pass{ true };
+        for (int i{ n }; i--;)
+        {
+            auto const q{ tbx::rand_quaternion() };
+            pass = std::abs(::geometric__norm(q) - 1.0) < 1e-12 && pass;
+            for (std::size_t j{}; j < 4u; ++j)
+                mean_square[j] += q[j] * q[j] / n;
+        }
+        for (auto const m : mean_square)
+            pass = std::abs(m - 0.25) < 8.0 * 0.2 / std::sqrt(static_cast<double>(n)) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool geometric__test_bulk()
+    {
+        enum : std::size_t { n = 1'000u };  // spans several blocks
+        std::vector<double> w(n), x(n), y(n), z(n);
+        auto pass{ true };
+        tbx::rand_on_sphere(x.data(), y.data(), z.data(), n, 3.0);
+        for (std::size_t i{}; i < n; ++i)
+            pass = std::abs(::geometric__norm(std::array<double, 3u>{ x[i], y[i], z[i] }) - 3.0) < 1e-12 && pass;
+        tbx::rand_in_ball(x.data(), y.data(), z.data(), n, 3.0);
+        for (std::size_t i{}; i < n; ++i)
+            pass = ::geometric__norm(std::array<double, 3u>{ x[i], y[i], z[i] }) <= 3.0 && pass;
+        tbx::rand_in_disk(x.data(), y.data(), n, 3.0);
+        for (std::size_t i{}; i < n; ++i)
+            pass = ::geometric__norm(std::array<double, 2u>{ x[i], y[i] }) <= 3.0 && pass;
+        tbx::rand_quaternion(w.data(), x.data(), y.data(), z.data(), n);
+        for (std::size_t i{}; i < n; ++i)
+            pass = std::abs(::geometric__norm(std::array<double, 4u>{ w[i], x[i], y[i], z[i] }) - 1.0) < 1e-12 && pass;
+        pass = std::adjacent_find(w.begin(), w.end()) == w.end() && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool geometric__test_invalid_argument()
+    {
+        auto pass{ true };
+        for (auto const radius : { -1.0, std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() })
+        {
+            try
+            {
+                tbx::rand_in_disk(radius);
+                pass = false;
+            }
+            catch (std::invalid_argument const&)
+            {
+            }
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - geometric sampling
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_geometric(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::geometric__test_unit_vector<1u>     () && pass;
+        pass = ::geometric__test_unit_vector<2u>     () && pass;
+        pass = ::geometric__test_unit_vector<3u>     () && pass;
+        pass = ::geometric__test_unit_vector<4u>     () && pass;
+        pass = ::geometric__test_unit_vector<7u>     () && pass;
+        pass = ::geometric__test_disk_ball_sphere    () && pass;
+        pass = ::geometric__test_quaternion          () && pass;
+        pass = ::geometric__test_bulk                () && pass;
+        pass = ::geometric__test_invalid_argument    () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_unit_vector, rand_in_disk, etc. \n";
+        return pass;
+    }
+}
+
+#if defined(TBX_RAND_TAPE)
+//======================================================================
+// Test Routines - variate tape
+//======================================================================
+namespace
+{
+    bool tape__test_record_replay()
+    {
+        // A replay returns the recorded values, whatever the state of
+        // the engine, and then reports the end of the tape.
+        char const* const path{ "tbx.rand.tape_test.int.bin" };
+        tbx::srand(::make_arbitrary_seed());
+        std::vector<int> recorded;
+        tbx::tape_record(path);
+        auto pass{ tbx::tape_status() == tbx::tape_mode::record };
+        for (int i{ 10'000 }; i--;)
+        {
+            recorded.push_back(tbx::rand());
+            recorded.push_back(tbx::rand(1, 6));
+            recorded.push_back(tbx::rand(tbx::param_type<int>{ -5, 5 }));
+        }
+        pass = tbx::tape_position() == recorded.size() && pass;
+        tbx::tape_stop();
+        tbx::srand(::make_arbitrary_seed() + 1u);
+        tbx::tape_replay(path);
+        pass = tbx::tape_status() == tbx::tape_mode::replay && pass;
+        for (std::size_t i{}; i < recorded.size(); i += 3u)
+        {
+            pass = tbx::rand() == recorded[i] && pass;
+            pass = tbx::rand(1, 6) == recorded[i + 1u] && pass;
+            pass = tbx::rand(tbx::param_type<int>{ -5, 5 }) == recorded[i + 2u] && pass;
+        }
+        auto ran_past_end{ false };
+        try { tbx::rand(); }
+        catch (tbx::tape_divergence const&) { ran_past_end = true; }
+        pass = ran_past_end && pass;
+        tbx::tape_stop();
+        pass = tbx::tape_status() == tbx::tape_mode::off && pass;
+        std::remove(path);
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool tape__test_divergence()
+    {
+        // A replay that makes a different call from the recording
+        // throws, and so does a tape of another ResultType.
+        char const* const path{ "tbx.rand.tape_test.double.bin" };
+        tbx::tape_record<double>(path);
+        tbx::rand<double>();
+        tbx::rand<double>(0.0, 10.0);
+        tbx::tape_stop<double>();
+        tbx::tape_replay<double>(path);
+        tbx::rand<double>();
+        auto diverged{ false };
+        try { tbx::rand<double>(0.0, 20.0); }
+        catch (tbx::tape_divergence const&) { diverged = true; }
+        auto pass{ diverged };
+        tbx::tape_stop<double>();
+        auto wrong_type{ false };
+        try { tbx::tape_replay<char>(path); }
+        catch (std::runtime_error const&) { wrong_type = true; }
+        pass = wrong_type && tbx::tape_status<char>() == tbx::tape_mode::off && pass;
+        auto missing{ false };
+        try { tbx::tape_replay<double>("tbx.rand.tape_test.missing.bin"); }
+        catch (std::runtime_error const&) { missing = true; }
+        pass = missing && pass;
+        std::remove(path);
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - variate tape
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_tape(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::tape__test_record_replay () && pass;
+        pass = ::tape__test_divergence    () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::tape_record, tbx::tape_replay \n";
+        return pass;
+    }
+}
+#endif
+//======================================================================
+// Test Routines - rand_sorted, rand_sorted_range
+//======================================================================
+namespace
+{
+    // The expected value of the order statistic X(i), i = 0, ..., n - 1,
+    // of n uniform integers on [0, m)
+    double sorted__expected_integer(std::size_t const i, std::size_t const n, std::size_t const m)
+    {
+        // E[X(i)] is the sum, over j = 1, ..., m - 1, of P(X(i) >= j),
+        // i.e., of the probability that at most i values are below j.
+        double e{};
+        for (std::size_t j{ 1u }; j < m; ++j)
+        {
+            auto const q{ static_cast<double>(j) / static_cast<double>(m) };
+            double term{ std::pow(1.0 - q, static_cast<double>(n)) }, cdf{ term };
+            for (std::size_t c{}; c < i; ++c)
+            {
+                term *= static_cast<double>(n - c) / static_cast<double>(c + 1u) * q / (1.0 - q);
+                cdf += term;
+            }
+            e += cdf;
+        }
+        return e;
+    }
+    //------------------------------------------------------------------
+    // Fill(v) writes v.size() sorted values. The mean of each order
+    // statistic, over many trials, is checked against expected(i),
+    // with a tolerance of about eight standard errors.
+    template <typename T, typename Fill, typename Expected>
+    bool sorted__check_order_statistics(std::size_t const n, Fill fill, Expected expected)
+    {
+        enum : std::size_t { n_trials = 20'000u };
+        std::vector<T> v(n);
+        std::vector<double> sum(n), sum_sq(n);
+        auto pass{ true };
+        for (std::size_t t{}; t < n_trials; ++t)
+        {
+            fill(v);
+            pass = std::is_sorted(v.begin(), v.end()) && pass;
+            for (std::size_t i{}; i < n; ++i)
+            {
+                sum[i] += static_cast<double>(v[i]);
+                sum_sq[i] += static_cast<double>(v[i]) * static_cast<double>(v[i]);
+            }
+        }
+        for (std::size_t i{}; i < n; ++i)
+        {
+            auto const mean{ sum[i] / n_trials };
+            auto const variance{ sum_sq[i] / n_trials - mean * mean };
+            pass = std::abs(mean - expected(i)) < 8.0 * std::sqrt(variance / n_trials) + 1e-9 && pass;
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_sorted__test_integral()
+    {
+        // Dense ranges, with many ties, and sparse ranges, with few
+        auto pass{ true };
+        for (auto const& [n, m] : { std::pair<std::size_t, std::size_t>
+            { 1u, 6u }, { 3u, 2u }, { 3u, 4u }, { 10u, 12u }, { 20u, 10u }, { 8u, 1'000u }, { 5u, 1'000'000u } })
+        {
+            auto expected = [n = n, m = m](std::size_t const i) { return ::sorted__expected_integer(i, n, m); };
+            auto const b{ static_cast<int>(m) - 1 };
+            pass = ::sorted__check_order_statistics<int>(n, [b](std::vector<int>& v) {
+                tbx::rand_sorted(v.begin(), v.size(), b, 0);
+            }, expected) && pass;
+            pass = ::sorted__check_order_statistics<int>(n, [b](std::vector<int>& v) {
+                tbx::rand_sorted_range<int> r(v.size(), 0, b);
+                std::copy(r.begin(), r.end(), v.begin());
+            }, expected) && pass;
+        }
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_sorted__test_real()
+    {
+        // E[X(i)] = (i + 1) / (n + 1) on [0, 1)
+        auto pass{ true };
+        for (std::size_t const n : { 1u, 2u, 10u })
+        {
+            auto expected = [n](std::size_t const i) { return -1.0 + 2.0 * static_cast<double>(i + 1u) / static_cast<double>(n + 1u); };
+            pass = ::sorted__check_order_statistics<double>(n, [](std::vector<double>& v) {
+                tbx::rand_sorted(v.begin(), v.size(), 1.0, -1.0);
+            }, expected) && pass;
+            pass = ::sorted__check_order_statistics<float>(n, [](std::vector<float>& v) {
+                tbx::rand_sorted_range<float> r(v.size(), -1.0f, 1.0f);
+                std::copy(r.begin(), r.end(), v.begin());
+            }, expected) && pass;
+            pass = ::sorted__check_order_statistics<double>(n, [](std::vector<double>& v) {
+                std::vector<double> w;
+                tbx::rand_sorted(std::back_inserter(w), v.size(), -1.0, 1.0);  // not a forward iterator
+                v = w;
+            }, expected) && pass;
+
+            // The value_type of out is not ResultType.
+            pass = ::sorted__check_order_statistics<float>(n, [](std::vector<float>& v) {
+                tbx::rand_sorted(v.begin(), v.size(), 1.0, -1.0);
+            }, expected) && pass;
+            pass = ::sorted__check_order_statistics<int>(n, [](std::vector<int>& v) {
+                tbx::rand_sorted(v.begin(), v.size(), 0.0, 100.0);  // floor(U * 100) on [0, 100)
+            }, [n](std::size_t const i) { return ::sorted__expected_integer(i, n, 100u); }) && pass;
+        }
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_sorted__test_bulk()
+    {
+        // Many values, over full and partial ranges, in either form
+        enum : std::size_t { n = 1'000'003u };
+        std::vector<std::uint64_t> u(n);
+        std::vector<double> d(n);
+        std::vector<bool> b(n);
+        tbx::rand_sorted<std::uint64_t>(u.begin(), n);
+        tbx::rand_sorted(d.begin(), n, 10.0, 20.0);
+        tbx::rand_sorted<bool>(b.begin(), n);
+        auto pass{ std::is_sorted(u.begin(), u.end()) && u.front() < u.back() };
+        pass = std::is_sorted(d.begin(), d.end()) && 10.0 <= d.front() && d.back() < 20.0 && pass;
+        pass = std::is_sorted(b.begin(), b.end()) && !b.front() && b.back() && pass;
+        tbx::rand_sorted_range<long double> r(n, 0.0L, 1e-300L);
+        pass = r.size() == n && !r.empty() && pass;
+        std::size_t count{};
+        long double last{};
+        for (auto const x : r)
+        {
+            pass = last <= x && x < 1e-300L && pass;
+            last = x;
+            ++count;
+        }
+        pass = count == n && r.empty() && r.size() == 0u && pass;
+        tbx::rand_sorted_range<short> empty(0u);
+        pass = empty.begin() == empty.end() && pass;
+        auto threw{ false };
+        try { tbx::rand_sorted(d.begin(), n, 1.0, 1.0); }
+        catch (std::invalid_argument const&) { threw = true; }
+        pass = threw && pass;
+        threw = false;
+        try { tbx::rand_sorted(d.begin(), 5u, -1e308, 1e308); }  // b - a overflows
+        catch (std::invalid_argument const&) { threw = true; }
+        pass = threw && pass;
+        threw = false;
+        try { tbx::rand_sorted_range<double> r(5u, -1e308, 1e308); }
+        catch (std::invalid_argument const&) { threw = true; }
+        pass = threw && pass;
+        tbx::rand_sorted_range<float> wide(5u, -3e38f, 3e38f);  // b - a is finite in double
+        pass = wide.size() == 5u && pass;
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_sorted, rand_sorted_range
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_rand_sorted(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_sorted__test_integral () && pass;
+        pass = ::rand_sorted__test_real     () && pass;
+        pass = ::rand_sorted__test_bulk     () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_sorted, tbx::rand_sorted_range \n";
+        return pass;
+    }
+}
+//======================================================================
+// Test Routines - shadow validation
+//======================================================================
+namespace
+{
+    template <typename T>
+    bool shadow__test_random_calls(std::uint32_t const driver_seed)
+    {
+        // Over a long, random sequence of calls to rand(), rand(a, b),
+        // rand(param), and srand, a rand_replacement must return exactly
+        // the values of a std::mt19937, and a standard distribution,
+        // that receive the same calls. Under TBX_RAND_SHADOW, the
+        // shadow engine checks each call, too.
+        using distribution_type = typename tbx::rand_replacement<T>::distribution_type;
+        using param_type = typename distribution_type::param_type;
+        tbx::rand_replacement<T> r;
+        std::mt19937 reference{ 1u };
+        distribution_type dist, pick;
+        std::mt19937 driver{ driver_seed };
+        auto pass{ true };
+        for (int i{ 100'000 }; i--;)
+        {
+            auto const a{ pick(driver) };
+            auto const b{ pick(driver) };
+            auto const p{ a < b ? param_type{ a, b } : param_type{ b, a } };
+            switch (driver() % 16u)
+            {
+            case 0u:
+            {
+                auto const seed{ driver() };
+                r.srand(seed);
+                reference.seed(seed);
+                dist.reset();
+                break;
+            }
+            case 1u:
+            {
+                std::seed_seq sseq{ driver(), driver(), driver() };
+                if (driver() & 1u)
+                    r.srand(sseq);
+                else
+                    r.srand(static_cast<std::seed_seq const&>(sseq));
+                reference.seed(sseq);
+                dist.reset();
+                break;
+            }
+            case 2u: case 3u: case 4u: case 5u: case 6u:
+                pass = r.rand() == dist(reference) && pass;
+                break;
+            case 7u: case 8u: case 9u: case 10u: case 11u:
+                if (a != b || tbx::is_integral_v<T>)
+                    pass = r.rand(a, b) == dist(reference, p) && pass;
+                break;
+            default:
+                pass = r.rand(p) == dist(reference, p) && pass;
+                break;
+            }
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool shadow__test_random_calls()
+    {
+        auto const seed{ static_cast<std::uint32_t>(::make_arbitrary_seed()) };
+        auto pass{ true };
+        pass = ::shadow__test_random_calls<int>(seed) && pass;
+        pass = ::shadow__test_random_calls<short>(seed) && pass;
+        pass = ::shadow__test_random_calls<unsigned long long>(seed) && pass;
+        pass = ::shadow__test_random_calls<float>(seed) && pass;
+        pass = ::shadow__test_random_calls<double>(seed) && pass;
+        pass = ::shadow__test_random_calls<long double>(seed) && pass;
+        return pass;
+    }
+#if defined(TBX_RAND_SHADOW)
+    //------------------------------------------------------------------
+    template <typename T>
+    bool shadow__test_checked_calls()
+    {
+        // Every call is checked, including calls for bool and char
+        // types, and calls after srand(), which reads random_device.
+        // A call to urbg() suspends checking until the next srand.
+        auto const before{ tbx::rr<T>().shadow().calls() };
+        tbx::srand<T>();
+        for (int i{ 1'000 }; i--;)
+        {
+            tbx::rand<T>();
+            tbx::rand<T>(T{ 1 }, T{ 0 });
+        }
+        auto pass{ tbx::rr<T>().shadow().calls() == before + 2'000u && tbx::rr<T>().shadow().in_step() };
+        tbx::rr<T>().urbg();
+        pass = !tbx::rr<T>().shadow().in_step() && pass;
+        tbx::srand<T>(1u);
+        pass = tbx::rr<T>().shadow().in_step() && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool shadow__test_checked_calls()
+    {
+        auto pass{ true };
+        pass = ::shadow__test_checked_calls<bool>() && pass;
+        pass = ::shadow__test_checked_calls<char>() && pass;
+        pass = ::shadow__test_checked_calls<int>() && pass;
+        pass = ::shadow__test_checked_calls<double>() && pass;
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool shadow__test_checked_words()
+    {
+        // The bulk routines draw from urbg() directly. Every word they
+        // draw is checked against std::mt19937, across many twists.
+        enum : std::size_t { n = 10'000u };
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        tbx::srand<float>(arbitrary_seed);
+        tbx::srand<bool>(arbitrary_seed);
+        tbx::srand<std::size_t>(arbitrary_seed);
+        std::vector<float> v(n);
+        tbx::rand_range<float> r(-1.0f, 1.0f);
+        std::copy_n(r.begin(), n, v.begin());
+        std::vector<std::int8_t> q(n);
+        tbx::stochastic_round_int8(v.data(), q.data(), n, 100.0f);
+        std::vector<std::uint64_t> mask(n / 64u + 1u);
+        tbx::rand_mask(mask.data(), n, 0.3);
+        std::vector<std::size_t> bounds(n, 1'000u), values(n);
+        tbx::rand_bounded_batch(bounds.begin(), values.begin(), n);
+        tbx::shuffle(values.begin(), values.end());
+        auto pass{ tbx::rr<float>().urbg().words() >= n + n / 2u };
+        pass = tbx::rr<bool>().urbg().words() >= n && pass;
+        pass = tbx::rr<std::size_t>().urbg().words() > n && pass;  // shuffle batches its indices
+
+        // A copy is checked on its own.
+        auto g{ tbx::rr<float>().urbg() };
+        g.discard(n);
+        pass = g.words() == tbx::rr<float>().urbg().words() + n && pass;
+        tbx::srand<float>(1u);
+        pass = tbx::rr<float>().urbg().words() == 0u && pass;
+        assert(pass);
+        return pass;
+    }
+#endif
+}
+//======================================================================
+// Driver Routine - shadow validation
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_shadow(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::shadow__test_random_calls  () && pass;
+#if defined(TBX_RAND_SHADOW)
+        pass = ::shadow__test_checked_calls () && pass;
+        pass = ::shadow__test_checked_words () && pass;
+#endif
+        ost << (pass ? "  pass : " : "  FAIL : ") << "shadow validation against std::mt19937 \n";
+        return pass;
+    }
+}
+//======================================================================
+// Unit Tests - tbx::rand<bool>(p), bernoulli_param
+//======================================================================
+namespace
+{
+    bool bernoulli__test_frequencies()
+    {
+        auto pass{ true };
+        auto const n_samples{ 200'000 };
+        for (auto const p : { 0.0, 1.0, 0.5, 0.25, 0.1875, 0.3, 1e-3, 0.999, std::ldexp(1.0, -10) })
+        {
+            tbx::bernoulli_param const param{ p };
+            int n_true{};
+            for (int i{ n_samples }; i--;)
+                n_true += tbx::rand<bool>(param);
+            auto const sigma{ std::sqrt(n_samples * p * (1.0 - p)) };
+            pass = std::abs(n_true - n_samples * p) <= 6.0 * sigma && pass;
+        }
+        int n_true{};
+        for (int i{ n_samples }; i--;)
+            n_true += tbx::rand<bool>(0.7);
+        pass = std::abs(n_true - n_samples * 0.7) <= 6.0 * std::sqrt(n_samples * 0.21) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool bernoulli__test_dyadic_bits()
+    {
+        using param = tbx::bernoulli_param;
+        auto pass{ true };
+        pass = param{ 0.0 }.dyadic_bits() == 0u && pass;
+        pass = param{ 1.0 }.dyadic_bits() == 0u && pass;
+        pass = param{ 0.5 }.dyadic_bits() == 1u && pass;
+        pass = param{ 0.75 }.dyadic_bits() == 2u && pass;
+        pass = param{ 0.1875 }.dyadic_bits() == 4u && pass;
+        pass = param{ std::ldexp(1.0, -32) }.dyadic_bits() == 32u && pass;
+        pass = param{ std::ldexp(1.0, -33) }.dyadic_bits() == param::not_dyadic && pass;
+        pass = param{ 0.3 }.dyadic_bits() == param::not_dyadic && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool bernoulli__test_engine_words()
+    {
+        // A fair decision uses one bit, so 32 decisions use one word.
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        std::mt19937 reference{ arbitrary_seed };
+        tbx::srand<bool>(arbitrary_seed);
+        auto pass{ true };
+        auto const w{ reference() };
+        for (unsigned i{}; i < 32u; ++i)
+            pass = tbx::rand<bool>(0.5) == ((w >> i & 1u) == 0u) && pass;
+
+        // A decision for any other p uses one word, almost always.
+        tbx::bernoulli_param const p{ 0.3 };
+        for (int i{ 1'000 }; i--;)
+            pass = tbx::rand<bool>(p) == p(reference) && pass;
+
+        // p == 0 and p == 1 use none.
+        pass = !tbx::rand<bool>(0.0) && tbx::rand<bool>(1.0) && pass;
+        pass = tbx::rr<bool>().urbg()() == reference() && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool bernoulli__test_srand()
+    {
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        auto draw = [] {
+            std::vector<bool> v;
+            for (int i{ 100 }; i--;)
+            {
+                v.push_back(tbx::rand<bool>(0.3));
+                v.push_back(tbx::rand<bool>(tbx::bernoulli_param{ 0.125 }));
+                v.push_back(tbx::rand<bool>());
+            }
+            return v;
+        };
+        tbx::srand<bool>(arbitrary_seed);
+        tbx::rand<bool>(0.5);  // leave bits in the pool
+        auto const v1{ draw() };
+        tbx::srand<bool>(arbitrary_seed);
+        tbx::rand<bool>(0.5);
+        auto const v2{ draw() };
+        auto pass{ v1 == v2 };
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool bernoulli__test_invalid_argument()
+    {
+        auto pass{ true };
+        for (auto const p : { -0.25, 1.5, std::numeric_limits<double>::quiet_NaN() })
+        {
+            try
+            {
+                tbx::rand<bool>(p);
+                pass = false;
+            }
+            catch (std::invalid_argument const&) {}
+        }
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - tbx::rand<bool>(p), bernoulli_param
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_bernoulli(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::bernoulli__test_frequencies       () && pass;
+        pass = ::bernoulli__test_dyadic_bits       () && pass;
+        pass = ::bernoulli__test_engine_words      () && pass;
+        pass = ::bernoulli__test_srand             () && pass;
+        pass = ::bernoulli__test_invalid_argument  () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand<bool>(p), tbx::bernoulli_param \n";
+        return pass;
+    }
+}
+//======================================================================
+// Unit Tests - bulk_isa
+//======================================================================
+namespace
+{
+    bool bulk_isa__test_names()
+    {
+        auto pass{ tbx::bulk_isa_selected() <= tbx::bulk_isa_supported() };
+        pass = std::string{ tbx::bulk_isa_name(tbx::bulk_isa::baseline) } == "baseline" && pass;
+        pass = std::string{ tbx::bulk_isa_name(tbx::bulk_isa::sse4_2) } == "sse4.2" && pass;
+        pass = std::string{ tbx::bulk_isa_name(tbx::bulk_isa::avx2) } == "avx2" && pass;
+        pass = std::string{ tbx::bulk_isa_name(tbx::bulk_isa::avx512) } == "avx512" && pass;
+#if !defined(TBX_RAND_CPU_DISPATCH)
+        pass = tbx::bulk_isa_supported() == tbx::bulk_isa::baseline && pass;
+#endif
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool bulk_isa__test_select()
+    {
+        auto pass{ true };
+        auto const selected{ tbx::bulk_isa_selected() };
+        tbx::bulk_isa_select(tbx::bulk_isa::baseline);
+        pass = tbx::bulk_isa_selected() == tbx::bulk_isa::baseline && pass;
+        if (tbx::bulk_isa_supported() < tbx::bulk_isa::avx512)
+        {
+            try
+            {
+                tbx::bulk_isa_select(tbx::bulk_isa::avx512);
+                pass = false;
+            }
+            catch (std::invalid_argument const&) {}
+            pass = tbx::bulk_isa_selected() == tbx::bulk_isa::baseline && pass;
+        }
+        tbx::bulk_isa_select(selected);
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    template <typename T>
+    std::vector<T> bulk_isa__draw(T const a, T const b)
+    {
+        tbx::srand<T>(1234u);
+        tbx::rand_range<T> r{ a, b };
+        std::vector<T> v(2'000u);
+        std::copy_n(r.begin(), v.size(), v.begin());
+        return v;
+    }
+    template <typename T>
+    std::vector<T> bulk_isa__draw_bounded()
+    {
+        // Bounds of every size, including some that reject often
+        tbx::srand<T>(1234u);
+        std::vector<T> bounds(2'000u), v(bounds.size());
+        for (std::size_t i{}; i < bounds.size(); ++i)
+            bounds[i] = static_cast<T>(i % 7u == 0u ? 0x8000'0001u : i + 1u);
+        tbx::rand_bounded_batch(bounds.begin(), v.begin(), v.size());
+        return v;
+    }
+    bool bulk_isa__test_variants_agree()
+    {
+        // Every variant the CPU supports computes the same values.
+        auto const selected{ tbx::bulk_isa_selected() };
+        auto draw = [] {
+            tbx::mt19937 e{ 1234u };
+            std::vector<std::uint32_t> words(2'000u);
+            for (auto& w : words)
+                w = e();
+            return std::make_tuple(words
+                , ::bulk_isa__draw<int>(-5, 1'000)
+                , ::bulk_isa__draw<unsigned char>(0u, 9u)
+                , ::bulk_isa__draw<float>(-1.0f, 2.3f)
+                , ::bulk_isa__draw<double>(0.5, 10.1)
+                , ::bulk_isa__draw_bounded<std::uint32_t>()
+                , ::bulk_isa__draw_bounded<long long>());
+        };
+        tbx::bulk_isa_select(tbx::bulk_isa::baseline);
+        auto const expected{ draw() };
+        std::mt19937 reference{ 1234u };
+        auto pass{ true };
+        for (auto const w : std::get<0>(expected))
+            pass = w == reference() && pass;
+        for (auto const isa : { tbx::bulk_isa::sse4_2, tbx::bulk_isa::avx2, tbx::bulk_isa::avx512 })
+        {
+            if (tbx::bulk_isa_supported() < isa)
+                break;
+            tbx::bulk_isa_select(isa);
+            pass = draw() == expected && pass;
+        }
+        tbx::bulk_isa_select(selected);
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - bulk_isa
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_bulk_isa(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::bulk_isa__test_names           () && pass;
+        pass = ::bulk_isa__test_select          () && pass;
+        pass = ::bulk_isa__test_variants_agree  () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::bulk_isa (selected: "
+            << tbx::bulk_isa_name(tbx::bulk_isa_selected()) << ") \n";
+        return pass;
+    }
+}
+//======================================================================
+// Unit Tests - rand_mask, stochastic_round_int8, stochastic_round_bf16
+//======================================================================
+namespace
+{
+    std::size_t rand_mask__count(std::vector<std::uint64_t> const& mask, std::size_t const n)
+    {
+        std::size_t count{};
+        for (std::size_t i{}; i < n; ++i)
+            count += mask[i / 64u] >> i % 64u & 1u;
+        return count;
+    }
+    //------------------------------------------------------------------
+    bool rand_mask__test_frequencies()
+    {
+        auto pass{ true };
+        std::size_t const n{ 100'003u };
+        std::vector<std::uint64_t> mask(n / 64u + 1u);
+        for (auto const keep : { 0.0, 1.0, 0.5, 0.25, 0.8125, std::ldexp(1.0, -32), 0.3, 0.9 })
+        {
+            std::fill(mask.begin(), mask.end(), std::uint64_t{ 0x5555'5555'5555'5555u });
+            tbx::rand_mask(mask.data(), n, keep);
+            auto const sigma{ std::sqrt(n * keep * (1.0 - keep)) };
+            pass = std::abs(::rand_mask__count(mask, n) - n * keep) <= 6.0 * sigma + 1.0 && pass;
+            pass = mask.back() >> n % 64u == 0u && pass;  // bits past n are cleared
+
+            // Adjacent bits are independent.
+            std::size_t pairs{};
+            for (std::size_t i{ 1u }; i < n; ++i)
+                pairs += (mask[i / 64u] >> i % 64u & 1u) & (mask[(i - 1u) / 64u] >> (i - 1u) % 64u & 1u);
+            auto const p2{ keep * keep };
+            pass = std::abs(pairs - (n - 1u) * p2) <= 6.0 * std::sqrt(n * p2 * (1.0 - p2)) + 1.0 && pass;
+        }
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool rand_mask__test_srand()
+    {
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        std::vector<std::uint64_t> v1(40u), v2(40u);
+        tbx::srand<bool>(arbitrary_seed);
+        tbx::rand_mask(v1.data(), 1'000u, 0.375);
+        tbx::rand_mask(v1.data() + 20, 1'000u, tbx::bernoulli_param{ 0.6 });
+        tbx::srand<bool>(arbitrary_seed);
+        tbx::rand_mask(v2.data(), 1'000u, tbx::bernoulli_param{ 0.375 });
+        tbx::rand_mask(v2.data() + 20, 1'000u, 0.6);
+        auto pass{ v1 == v2 };
+
+        // A fair mask is the engine's words, two to a mask word.
+        std::mt19937 reference{ arbitrary_seed };
+        tbx::srand<bool>(arbitrary_seed);
+        tbx::rand_mask(v1.data(), 64u, 0.5);
+        auto const hi{ std::uint64_t{ reference() } };
+        pass = v1[0] == (hi << 32 | reference()) && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool stochastic_round__test_int8()
+    {
+        auto pass{ true };
+        std::size_t const n{ 100'000u };
+        std::vector<float> in(n);
+        std::vector<std::int8_t> out(n);
+        for (auto const x : { 2.3f, -2.3f, 0.5f, -126.75f, 100.0f })
+        {
+            std::fill(in.begin(), in.end(), x);
+            tbx::stochastic_round_int8(in.data(), out.data(), n);
+            double sum{};
+            for (auto const y : out)
+            {
+                pass = (y == std::floor(x) || y == std::ceil(x)) && pass;
+                sum += y;
+            }
+            auto const frac{ x - std::floor(x) };
+            pass = std::abs(sum / n - x) <= 6.0 * std::sqrt(frac * (1.0 - frac) / n) + 1e-9 && pass;
+        }
+        float const special[]{ 1e6f, -1e6f, std::numeric_limits<float>::quiet_NaN(), 0.5f, 127.0f, -128.0f };
+        std::int8_t result[6];
+        tbx::stochastic_round_int8(special, result, 6u, 10.0f);
+        pass = result[0] == 127 && result[1] == -128 && result[2] == 0 && pass;
+        pass = result[3] == 5 && result[4] == 127 && result[5] == -128 && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    float stochastic_round__from_bf16(std::uint16_t const b)
+    {
+        auto const u{ std::uint32_t{ b } << 16 };
+        float x;
+        std::memcpy(&x, &u, sizeof x);
+        return x;
+    }
+    bool stochastic_round__test_bf16()
+    {
+        auto pass{ true };
+        std::size_t const n{ 100'000u };
+        std::vector<float> in(n);
+        std::vector<std::uint16_t> out(n);
+        for (auto const x : { 1.0f + std::ldexp(1.0f, -10), -3.14159f, 1e-30f, 1.0f })
+        {
+            std::fill(in.begin(), in.end(), x);
+            tbx::stochastic_round_bf16(in.data(), out.data(), n);
+            double sum{};
+            for (auto const y : out)
+                sum += ::stochastic_round__from_bf16(y);
+            auto const step{ std::ldexp(std::abs(x), -7) };
+            pass = std::abs(sum / n - x) <= 6.0 * step / std::sqrt(n) && pass;
+        }
+        auto const inf{ std::numeric_limits<float>::infinity() };
+        float const special[]{ inf, -inf, std::numeric_limits<float>::quiet_NaN(), 1.5f, -0.0f };
+        std::uint16_t result[5];
+        tbx::stochastic_round_bf16(special, result, 5u);
+        pass = ::stochastic_round__from_bf16(result[0]) == inf && pass;
+        pass = ::stochastic_round__from_bf16(result[1]) == -inf && pass;
+        pass = std::isnan(::stochastic_round__from_bf16(result[2])) && pass;
+        pass = result[3] == 0x3fc0u && result[4] == 0x8000u && pass;
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool stochastic_round__test_variants_agree()
+    {
+        // Every variant the CPU supports computes the same values.
+        auto const selected{ tbx::bulk_isa_selected() };
+        std::vector<float> in(1'000u);
+        for (std::size_t i{}; i < in.size(); ++i)
+            in[i] = static_cast<float>(i) * 0.37f - 150.0f;
+        auto draw = [&in] {
+            std::vector<std::uint64_t> m1(20u), m2(20u);
+            std::vector<std::int8_t> i8(in.size());
+            std::vector<std::uint16_t> bf(in.size());
+            tbx::srand<bool>(99u);
+            tbx::rand_mask(m1.data(), 1'250u, 0.8125);
+            tbx::rand_mask(m2.data(), 1'250u, 0.3);
+            tbx::srand<float>(99u);
+            tbx::stochastic_round_int8(in.data(), i8.data(), in.size(), 0.5f);
+            tbx::stochastic_round_bf16(in.data(), bf.data(), in.size());
+            return std::make_tuple(m1, m2, i8, bf);
+        };
+        tbx::bulk_isa_select(tbx::bulk_isa::baseline);
+        auto const expected{ draw() };
+        auto pass{ true };
+        for (auto const isa : { tbx::bulk_isa::sse4_2, tbx::bulk_isa::avx2, tbx::bulk_isa::avx512 })
+        {
+            if (tbx::bulk_isa_supported() < isa)
+                break;
+            tbx::bulk_isa_select(isa);
+            pass = draw() == expected && pass;
+        }
+        tbx::bulk_isa_select(selected);
+        assert(pass);
+        return pass;
+    }
+    //------------------------------------------------------------------
+    bool stochastic_round__test_srand()
+    {
+        auto const arbitrary_seed{ ::make_arbitrary_seed() };
+        std::vector<float> in(777u, 0.25f);
+        std::vector<std::int8_t> v1(in.size()), v2(in.size());
+        tbx::srand<float>(arbitrary_seed);
+        tbx::stochastic_round_int8(in.data(), v1.data(), in.size());
+        tbx::srand<float>(arbitrary_seed);
+        tbx::stochastic_round_int8(in.data(), v2.data(), in.size());
+        auto pass{ v1 == v2 };
+        assert(pass);
+        return pass;
+    }
+}
+//======================================================================
+// Driver Routine - rand_mask, stochastic_round_int8, stochastic_round_bf16
+//======================================================================
+namespace
+{
+    template <typename charT, typename traits>
+    bool test_mask_and_rounding(std::basic_ostream<charT, traits>& ost)
+    {
+        auto pass{ true };
+        pass = ::rand_mask__test_frequencies             () && pass;
+        pass = ::rand_mask__test_srand                   () && pass;
+        pass = ::stochastic_round__test_int8             () && pass;
+        pass = ::stochastic_round__test_bf16             () && pass;
+        pass = ::stochastic_round__test_variants_agree   () && pass;
+        pass = ::stochastic_round__test_srand            () && pass;
+        ost << (pass ? "  pass : " : "  FAIL : ") << "tbx::rand_mask, tbx::stochastic_round_int8, tbx::stochastic_round_bf16 \n";
+        return pass;
+    }
+}
+//======================================================================
 // Driver Routine - All Tests
 //======================================================================
 namespace tbx
@@ -891,6 +3582,33 @@ namespace tbx
             pass = ::omit_result_type<charT, traits>(ost) && pass;
             pass = ::bool_result_type<charT, traits>(ost) && pass;
             pass = ::vary_result_type<charT, traits>(ost) && pass;
+            pass = ::test_shuffle<charT, traits>(ost) && pass;
+            pass = ::test_sample_indices<charT, traits>(ost) && pass;
+            pass = ::test_random_permutation<charT, traits>(ost) && pass;
+            pass = ::test_rand_range<charT, traits>(ost) && pass;
+            pass = ::test_rand_string<charT, traits>(ost) && pass;
+            pass = ::test_constexpr_rand<charT, traits>(ost) && pass;
+            pass = ::test_rand_counts<charT, traits>(ost) && pass;
+            pass = ::test_rand_poisson_binomial_gamma<charT, traits>(ost) && pass;
+            pass = ::test_monte_carlo_reduce<charT, traits>(ost) && pass;
+            pass = ::test_task_rng<charT, traits>(ost) && pass;
+#if defined(TBX_RAND_ENGINE_POOL)
+            pass = ::test_engine_pool<charT, traits>(ost) && pass;
+#endif
+            pass = ::test_fixed_seed_seq<charT, traits>(ost) && pass;
+            pass = ::test_mt19937<charT, traits>(ost) && pass;
+            pass = ::test_rand_bounded_batch<charT, traits>(ost) && pass;
+            pass = ::test_return_types<charT, traits>(ost) && pass;
+            pass = ::test_qrand<charT, traits>(ost) && pass;
+            pass = ::test_geometric<charT, traits>(ost) && pass;
+#if defined(TBX_RAND_TAPE)
+            pass = ::test_tape<charT, traits>(ost) && pass;
+#endif
+            pass = ::test_rand_sorted<charT, traits>(ost) && pass;
+            pass = ::test_shadow<charT, traits>(ost) && pass;
+            pass = ::test_bernoulli<charT, traits>(ost) && pass;
+            pass = ::test_bulk_isa<charT, traits>(ost) && pass;
+            pass = ::test_mask_and_rounding<charT, traits>(ost) && pass;
         }
         else
         {
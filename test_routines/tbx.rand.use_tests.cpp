@@ -99,15 +99,23 @@ namespace
         std::array<int, n_outcomes> count{};
         auto const p{ tbx::param_type<int>(1, 6) };
         tbx::srand();
-        for (auto i{ n_rolls }; i--;)
+        if (show_detail)
         {
-            auto const r = tbx::rand(p);
-            if (show_detail)
+            for (auto i{ n_rolls }; i--;)
+            {
+                auto const r = tbx::rand(p);
                 ost << r << ' ';
-            ++count[r - one];
-        }
-        if (show_detail)
+                ++count[r - one];
+            }
             ost << "\n\n";
+        }
+        else
+        {
+            // Only the totals are needed, so the rolls themselves are skipped.
+            auto const totals{ tbx::rand_counts(static_cast<std::uint64_t>(n_rolls), p.a(), p.b()) };
+            for (std::size_t i{}; i < n_outcomes; ++i)
+                count[i] = static_cast<int>(totals[i]);
+        }
         ost << "Counts:\n";
         auto die{ 0 };
         for (auto const& c : count)
@@ -127,12 +135,8 @@ namespace
     template <typename result_type>
     auto printable_ascii_string(int const length)
     {
-        std::string s;  // expecting NVRO
-        tbx::param_type<int> p('!', '~');  // same as p(0x21, 0x7e)
         tbx::srand<result_type>();
-        for (auto i{ length }; i--;)
-            s.push_back(tbx::rand<result_type>(p));
-        return s;
+        return tbx::rand_string<result_type>(length, tbx::charsets::printable_ascii);
     }
     template <typename charT, typename traits, typename result_type>
     bool display_random_ascii
@@ -0,0 +1,364 @@
+//================================================================================
+// "MIT License"
+//================================================================================
+// Copyright 2023 Michael J. Mannon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//================================================================================
+
+//======================================================================
+// tbx_rand - stream random values to stdout or a file
+//======================================================================
+// Build, from the directory that holds tbx.rand.h:
+//
+//   g++ -std=c++17 -O3 -pthread -I. tools/tbx_rand.cpp -o tbx_rand
+//
+// There is no need for -march: the bulk kernels of tbx.rand.h select
+// the instruction set at run time. --help shows the selection.
+//
+// Usage:
+//
+//   tbx_rand [-t type] [-a a] [-b b] [-s seed] [-S stream] [-n count]
+//            [-f raw|text|csv] [-c columns] [-j threads] [-o file]
+//
+//   -t, --type     any ResultType from README.md, e.g. int, unsigned char,
+//                  double, uint64_t (default: int)
+//   -a, -b         the range, as in tbx::rand<type>(a, b). The default
+//                  is the range of tbx::rand<type>().
+//   -s, --seed     the seed (default: 1)
+//   -S, --stream   the substream; each stream of a seed is independent
+//                  (default: 0)
+//   -n, --count    the number of values; 0 means endless (default: 0)
+//   -f, --format   raw (native binary), text (one value per line), or
+//                  csv (default: raw)
+//   -c, --columns  values per line, in csv format (default: 8)
+//   -j, --threads  generator threads (default: all hardware threads)
+//   -o, --output   the output file (default: stdout)
+//
+// The output is split into chunks of 65,536 values. Chunk k is drawn
+// from a tbx::splitmix64 engine whose seed is a hash of seed, stream,
+// and k, so chunks can be generated, and formatted, in parallel. The
+// output depends only on the options above, never on the number of
+// threads. It is not the same sequence as tbx::rand<type>() returns
+// after tbx::srand<type>(seed).
+//
+// While one batch of chunks is written, with one large unbuffered
+// write per chunk, the threads generate the next batch.
+//======================================================================
+
+#include <charconv>     // to_chars
+#include <cstdint>      // uint64_t
+#include <cstdio>       // fclose, fopen, fprintf, fputs, fwrite, printf, setvbuf
+#include <cstdlib>      // strtold, strtoull
+#include <cstring>      // memcpy
+#include <exception>    // exception
+#include <limits>       // numeric_limits
+#include <memory>       // unique_ptr
+#include <stdexcept>    // invalid_argument, runtime_error
+#include <string>       // string
+#include <string_view>  // string_view
+#include <thread>       // thread
+#include <type_traits>  // conditional_t, integral_constant, is_floating_point_v, is_signed_v
+#include <vector>       // vector
+#include "tbx.rand.h"
+
+namespace
+{
+    enum class format { raw, text, csv };
+    enum : std::size_t { chunk_size = 65'536u };
+    //------------------------------------------------------------------
+    struct options
+    {
+        std::string type{ "int" };
+        std::string a;
+        std::string b;
+        std::uint64_t seed{ 1u };
+        std::uint64_t stream{};
+        std::uint64_t count{};
+        ::format fmt{ ::format::raw };
+        std::size_t columns{ 8u };
+        unsigned threads{ std::thread::hardware_concurrency() };
+        std::string output;
+    };
+    //------------------------------------------------------------------
+    char const* const usage
+    {
+        "usage: tbx_rand [-t type] [-a a] [-b b] [-s seed] [-S stream] [-n count]\n"
+        "                [-f raw|text|csv] [-c columns] [-j threads] [-o file]\n"
+    };
+    //------------------------------------------------------------------
+    std::uint64_t parse_u64(std::string const& s, char const* const name)
+    {
+        char* end{};
+        auto const x{ std::strtoull(s.c_str(), &end, 0) };
+        if (s.empty() || *end || s[0] == '-')
+            throw std::invalid_argument(std::string{ "tbx_rand: bad " } + name + ": " + s);
+        return x;
+    }
+    //------------------------------------------------------------------
+    template <typename T>
+    T parse_value(std::string const& s, char const* const name)
+    {
+        char* end{};
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            auto const x{ std::strtold(s.c_str(), &end) };
+            if (s.empty() || *end
+                || !(x >= std::numeric_limits<T>::lowest() && x <= std::numeric_limits<T>::max()))
+                throw std::invalid_argument(std::string{ "tbx_rand: bad " } + name + ": " + s);
+            return static_cast<T>(x);
+        }
+        else
+        {
+            using wide = std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>;
+            wide x{};
+            auto const [p, ec] { std::from_chars(s.data(), s.data() + s.size(), x) };
+            if (s.empty() || ec != std::errc{} || p != s.data() + s.size()
+                || x < static_cast<wide>(std::numeric_limits<T>::min())
+                || static_cast<wide>(std::numeric_limits<T>::max()) < x)
+                throw std::invalid_argument(std::string{ "tbx_rand: bad " } + name + ": " + s);
+            return static_cast<T>(x);
+        }
+    }
+    //------------------------------------------------------------------
+    options parse_options(int const argc, char** const argv)
+    {
+        options o;
+        for (int i{ 1 }; i < argc; ++i)
+        {
+            std::string_view const opt{ argv[i] };
+            if (opt == "-h" || opt == "--help")
+            {
+                std::fputs(::usage, stdout);
+                std::printf("bulk kernels: %s\n", tbx::bulk_isa_name(tbx::bulk_isa_selected()));
+                std::exit(0);
+            }
+            if (i + 1 == argc)
+                throw std::invalid_argument("tbx_rand: missing value for " + std::string{ opt });
+            std::string const value{ argv[++i] };
+            if (opt == "-t" || opt == "--type")
+                o.type = value.compare(0u, 5u, "std::") == 0 ? value.substr(5u) : value;
+            else if (opt == "-a")
+                o.a = value;
+            else if (opt == "-b")
+                o.b = value;
+            else if (opt == "-s" || opt == "--seed")
+                o.seed = ::parse_u64(value, "seed");
+            else if (opt == "-S" || opt == "--stream")
+                o.stream = ::parse_u64(value, "stream");
+            else if (opt == "-n" || opt == "--count")
+                o.count = ::parse_u64(value, "count");
+            else if (opt == "-c" || opt == "--columns")
+                o.columns = static_cast<std::size_t>(::parse_u64(value, "columns"));
+            else if (opt == "-j" || opt == "--threads")
+                o.threads = static_cast<unsigned>(::parse_u64(value, "threads"));
+            else if (opt == "-o" || opt == "--output")
+                o.output = value;
+            else if (opt == "-f" || opt == "--format")
+                o.fmt = value == "raw" ? ::format::raw
+                    : value == "text" ? ::format::text
+                    : value == "csv" ? ::format::csv
+                    : throw std::invalid_argument("tbx_rand: bad format: " + value);
+            else
+                throw std::invalid_argument("tbx_rand: unknown option: " + std::string{ opt });
+        }
+        if (o.columns == 0u)
+            throw std::invalid_argument("tbx_rand: columns must be positive");
+        if (o.threads == 0u)
+            o.threads = 1u;
+        return o;
+    }
+    //------------------------------------------------------------------
+    // The values, and the bytes to be written, of one chunk
+    template <typename T>
+    struct chunk
+    {
+        std::unique_ptr<T[]> values{ new T[chunk_size] };  // not std::vector<bool>
+        std::string text;
+        std::size_t size{};
+    };
+    //------------------------------------------------------------------
+    template <typename T>
+    class generator
+    {
+        options const& o_;
+        T a_;
+        T b_;
+        std::uint64_t root_;
+    public:
+        generator(options const& o, T const a, T const b) noexcept
+            : o_{ o }
+            , a_{ b < a ? b : a }
+            , b_{ b < a ? a : b }
+            , root_{ tbx::splitmix64::mix(o.seed) ^ tbx::splitmix64::mix(~o.stream) }
+        {}
+        std::uint64_t chunks() const noexcept
+        {
+            return o_.count
+                ? (o_.count + (chunk_size - 1u)) / chunk_size
+                : std::numeric_limits<std::uint64_t>::max();
+        }
+        void fill(::chunk<T>& c, std::uint64_t const k) const
+        {
+            auto const first{ k * chunk_size };
+            c.size = o_.count && o_.count - first < chunk_size
+                ? static_cast<std::size_t>(o_.count - first)
+                : std::size_t{ chunk_size };
+            tbx::splitmix64 g{ tbx::splitmix64::mix(root_ ^ k) };
+            using is_integral = std::integral_constant<bool, tbx::is_integral_v<T>>;
+            tbx::detail::generate_block(g, c.values.get(), c.size, a_, b_, is_integral{});
+            if (o_.fmt != ::format::raw)
+                format(c, first);
+        }
+    private:
+        void format(::chunk<T>& c, std::uint64_t const first) const
+        {
+            // Wide enough for any value, and its separator
+            enum : std::size_t { max_width = 64u };
+            c.text.resize(c.size * max_width);
+            auto* p{ c.text.data() };
+            for (std::size_t i{}; i < c.size; ++i)
+            {
+                auto const v{ c.values[i] };
+                if constexpr (std::is_floating_point_v<T>)
+                    p = std::to_chars(p, p + max_width, v).ptr;
+                else
+                    p = std::to_chars(p, p + max_width, +v).ptr;  // chars, and bools, as numbers
+                auto const index{ first + i + 1u };
+                *p++ = o_.fmt == ::format::text || index % o_.columns == 0u || index == o_.count ? '\n' : ',';
+            }
+            c.text.resize(static_cast<std::size_t>(p - c.text.data()));
+        }
+    };
+    //------------------------------------------------------------------
+    template <typename T>
+    void write(std::FILE* const f, ::chunk<T> const& c, ::format const fmt)
+    {
+        auto const* const bytes{ fmt == ::format::raw
+            ? reinterpret_cast<char const*>(c.values.get())
+            : c.text.data() };
+        auto const n{ fmt == ::format::raw ? c.size * sizeof(T) : c.text.size() };
+        if (std::fwrite(bytes, 1u, n, f) != n)
+            throw std::runtime_error("tbx_rand: write failed");
+    }
+    //------------------------------------------------------------------
+    template <typename T>
+    void run(options const& o, std::FILE* const f)
+    {
+        auto const a{ o.a.empty() ? T{} : ::parse_value<T>(o.a, "a") };
+        auto const b{ !o.b.empty() ? ::parse_value<T>(o.b, "b")
+            : std::is_floating_point_v<T> ? T{ 1 }
+            : std::numeric_limits<T>::max() };
+        if (std::is_floating_point_v<T> && !(a < b || b < a))
+            throw std::invalid_argument("tbx_rand: floating-point types require a != b");
+        ::generator<T> const gen(o, a, b);
+        auto const chunks{ gen.chunks() };
+        std::vector<::chunk<T>> batch(o.threads), next(o.threads);
+
+        // Fill batch with the chunks first, first + 1, ..., one thread
+        // per chunk, and return the number of chunks.
+        auto fill = [&gen, chunks](std::vector<::chunk<T>>& batch, std::uint64_t const first
+            , std::vector<std::thread>& workers)
+        {
+            auto const n{ chunks - first < batch.size() ? static_cast<std::size_t>(chunks - first) : batch.size() };
+            for (std::size_t i{}; i < n; ++i)
+                workers.emplace_back([&gen, &batch, first, i] { gen.fill(batch[i], first + i); });
+            return n;
+        };
+        std::vector<std::thread> workers;
+        auto n{ fill(batch, 0u, workers) };
+        for (auto& w : workers)
+            w.join();
+        for (std::uint64_t first{}; n; )
+        {
+            first += n;
+            workers.clear();
+            auto const n_next{ fill(next, first, workers) };
+            try
+            {
+                for (std::size_t i{}; i < n; ++i)
+                    ::write(f, batch[i], o.fmt);
+            }
+            catch (...)
+            {
+                for (auto& w : workers)
+                    w.join();
+                throw;
+            }
+            for (auto& w : workers)
+                w.join();
+            batch.swap(next);
+            n = n_next;
+        }
+    }
+    //------------------------------------------------------------------
+    void dispatch(options const& o, std::FILE* const f)
+    {
+        auto const& t{ o.type };
+        if      (t == "bool")                                   ::run<bool>(o, f);
+        else if (t == "char")                                   ::run<char>(o, f);
+        else if (t == "signed char")                            ::run<signed char>(o, f);
+        else if (t == "unsigned char")                          ::run<unsigned char>(o, f);
+        else if (t == "short")                                  ::run<short>(o, f);
+        else if (t == "unsigned short")                         ::run<unsigned short>(o, f);
+        else if (t == "int")                                    ::run<int>(o, f);
+        else if (t == "unsigned" || t == "unsigned int")        ::run<unsigned int>(o, f);
+        else if (t == "long")                                   ::run<long>(o, f);
+        else if (t == "unsigned long")                          ::run<unsigned long>(o, f);
+        else if (t == "long long")                              ::run<long long>(o, f);
+        else if (t == "unsigned long long")                     ::run<unsigned long long>(o, f);
+        else if (t == "float")                                  ::run<float>(o, f);
+        else if (t == "double")                                 ::run<double>(o, f);
+        else if (t == "long double")                            ::run<long double>(o, f);
+        else if (t == "int8_t")                                 ::run<std::int8_t>(o, f);
+        else if (t == "int16_t")                                ::run<std::int16_t>(o, f);
+        else if (t == "int32_t")                                ::run<std::int32_t>(o, f);
+        else if (t == "int64_t")                                ::run<std::int64_t>(o, f);
+        else if (t == "uint8_t")                                ::run<std::uint8_t>(o, f);
+        else if (t == "uint16_t")                               ::run<std::uint16_t>(o, f);
+        else if (t == "uint32_t")                               ::run<std::uint32_t>(o, f);
+        else if (t == "uint64_t")                               ::run<std::uint64_t>(o, f);
+        else throw std::invalid_argument("tbx_rand: unsupported type: " + t);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        auto const o{ ::parse_options(argc, argv) };
+        auto* const f{ o.output.empty() ? stdout : std::fopen(o.output.c_str(), "wb") };
+        if (!f)
+            throw std::runtime_error("tbx_rand: cannot open " + o.output);
+        // Every write is a whole chunk, so stdio buffering would only
+        // add a copy.
+        std::setvbuf(f, nullptr, _IONBF, 0u);
+        ::dispatch(o, f);
+        if (f != stdout && std::fclose(f) != 0)
+            throw std::runtime_error("tbx_rand: cannot close " + o.output);
+        return 0;
+    }
+    catch (std::exception const& e)
+    {
+        std::fprintf(stderr, "%s\n%s", e.what(), ::usage);
+        return 1;
+    }
+}
+
+// end file: tbx_rand.cpp